@@ -0,0 +1,128 @@
+#ifndef BLOCK_IO_HPP
+#define BLOCK_IO_HPP
+
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+///////////////////////////////////////////////////////////////////////////////
+// class blockReader
+///////////////////////////////////////////////////////////////////////////////
+
+/** Double buffered sequential reader. A background thread reads the next large
+  * block of the file while the caller processes the current one, so that reading
+  * and processing overlap.
+  */
+class blockReader{
+  public:
+	/** Constructor.
+	  * \param[in]  blockSize_ Size of each of the two blocks in bytes.
+	  */
+	blockReader(const size_t &blockSize_=16777216);
+
+	/// Destructor. Stops the background thread.
+	~blockReader();
+
+	/** Start reading a file from a given byte offset.
+	  * \param[in]  fd_     Descriptor of the file to read.
+	  * \param[in]  offset_ Byte offset at which to start reading (using pread).
+	  * \return True upon success and false if a file is already being read.
+	  */
+	bool start(const int &fd_, const unsigned long long &offset_=0);
+
+	/** Get the next block of data. The block remains valid until the next call.
+	  * \param[out] data_ Pointer to the start of the block.
+	  * \return The number of bytes in the block. Returns zero at the end of the file.
+	  */
+	size_t next(const char *&data_);
+
+	/// Stop the background thread.
+	void stop();
+
+	/// Return true if a read error occurred.
+	bool error() const { return failed; }
+
+  private:
+	std::vector<char> blocks[2]; ///< The two data blocks.
+	size_t lengths[2]; ///< Number of bytes in each block.
+	bool filled[2]; ///< Set to true when a block is ready to be consumed.
+
+	int current; ///< Index of the block held by the caller (or -1).
+	bool finished; ///< Set to true when the end of the file has been reached.
+	bool running; ///< Set to true while the background thread is running.
+	std::atomic<bool> failed; ///< Set to true if a read error occurred (also read without the lock).
+
+	std::thread worker; ///< Background reading thread.
+	std::mutex lock; ///< Protects the block states.
+	std::condition_variable signal; ///< Signals a change of block state.
+
+	/// Read blocks until the end of the file or until stopped.
+	void run(int fd_, unsigned long long offset_);
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// class blockWriter
+///////////////////////////////////////////////////////////////////////////////
+
+/** Double buffered sequential writer. Data is collected in a large block, which
+  * is written by a background thread once full while the next block is filled.
+  */
+class blockWriter{
+  public:
+	/** Constructor.
+	  * \param[in]  blockSize_ Size of each of the two blocks in bytes.
+	  */
+	blockWriter(const size_t &blockSize_=16777216);
+
+	/// Destructor. Flushes any remaining data.
+	~blockWriter();
+
+	/** Start writing to a file at its current position.
+	  * \param[in]  fd_ Descriptor of the file to write.
+	  * \return True upon success and false if a file is already being written.
+	  */
+	bool start(const int &fd_);
+
+	/** Append data to the output.
+	  * \param[in]  data_ Pointer to the data.
+	  * \param[in]  len_  The number of bytes to write.
+	  * \return True upon success and false if a write error has occurred.
+	  */
+	bool write(const char *data_, size_t len_);
+
+	/** Write all pending data and wait for it to complete.
+	  * \return True upon success and false if a write error has occurred.
+	  */
+	bool flush();
+
+	/// Flush all data and stop the background thread.
+	bool stop();
+
+	/// Return the total number of bytes passed to write().
+	unsigned long long getTotal() const { return total; }
+
+  private:
+	std::vector<char> blocks[2]; ///< The two data blocks.
+	size_t lengths[2]; ///< Number of bytes in each block.
+	bool full[2]; ///< Set to true when a block is waiting to be written.
+
+	int current; ///< Index of the block being filled.
+	bool running; ///< Set to true while the background thread is running.
+	std::atomic<bool> failed; ///< Set to true if a write error occurred (also read without the lock).
+
+	unsigned long long total; ///< Total number of bytes passed to write().
+
+	std::thread worker; ///< Background writing thread.
+	std::mutex lock; ///< Protects the block states.
+	std::condition_variable signal; ///< Signals a change of block state.
+
+	/// Hand the current block to the background thread and switch to the other one.
+	bool swap();
+
+	/// Write blocks until stopped.
+	void run(int fd_);
+};
+
+#endif
@@ -0,0 +1,115 @@
+#ifndef BUFFER_INDEX_HPP
+#define BUFFER_INDEX_HPP
+
+#include <string>
+#include <vector>
+
+class mappedFile;
+
+/// A single entry of the buffer index.
+struct indexEntry{
+	unsigned long long offset; ///< Byte offset of the start of the buffer in the data file.
+	unsigned int type; ///< The buffer type word.
+	unsigned int length; ///< Length of the buffer in 4 byte words.
+
+	indexEntry() : offset(0), type(0), length(0) { }
+
+	indexEntry(const unsigned long long &offset_, const unsigned int &type_, const unsigned int &length_) : offset(offset_), type(type_), length(length_) { }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// class bufferIndex
+///////////////////////////////////////////////////////////////////////////////
+
+/** Persistent index of the byte offset and type of every buffer in an ldf file.
+  * The index is stored in a sidecar file next to the data file (<filename>.idx)
+  * along with the size, modification time (in nanoseconds) and inode number of
+  * the data file. A stale sidecar (i.e. the data file has since changed or been
+  * replaced) is ignored and rebuilt.
+  */
+class bufferIndex{
+  public:
+	/// Default constructor.
+	bufferIndex() { }
+
+	/** Load the sidecar index of a data file, building and saving a new one if
+	  * it does not exist or is out of date.
+	  * \param[in]  fname_    Path to the data file.
+	  * \param[in]  input_    The opened (mapped) data file.
+	  * \param[in]  nThreads_ The number of threads to use when building the index.
+	  * \param[in]  rebuild_  Ignore any existing sidecar and always build a new index.
+	  * \return True if the index is available and false otherwise.
+	  */
+	bool load(const std::string &fname_, mappedFile &input_, const size_t &nThreads_=1, const bool &rebuild_=false);
+
+	/** Build the index by scanning the entire data file.
+	  * \param[in]  input_    The opened (mapped) data file.
+	  * \param[in]  nThreads_ The number of threads to use.
+	  * \return True upon success and false if the file is not mapped.
+	  */
+	bool build(mappedFile &input_, const size_t &nThreads_=1);
+
+	/** Read a sidecar index file. The size, modification time and inode number
+	  * of the data file which were stored in the sidecar are also read.
+	  * \param[in]  fname_ Path to the sidecar index file.
+	  * \return True if the index was read successfully and false otherwise.
+	  */
+	bool read(const std::string &fname_);
+
+	/** Write the index to a sidecar file.
+	  * \param[in]  fname_ Path to the sidecar index file.
+	  * \return True upon success and false otherwise.
+	  */
+	bool write(const std::string &fname_) const ;
+
+	/// Return the number of buffers in the index.
+	size_t size() const { return entries.size(); }
+
+	/// Return the size of the indexed data file in bytes.
+	unsigned long long getFileSize() const { return stamp.size; }
+
+	/// Return true if the index contains no buffers.
+	bool empty() const { return entries.empty(); }
+
+	/// Return a buffer from the index.
+	const indexEntry &at(const size_t &index_) const { return entries.at(index_); }
+
+	/** Find the Nth buffer of a given type.
+	  * \param[in]  n_    Zero based number of the buffer to find, counting only buffers of the requested type.
+	  * \param[in]  type_ The buffer type word. Buffers of any type are counted if this is zero.
+	  * \return The position of the buffer in the index, or -1 if there is no such buffer.
+	  */
+	long long find(const size_t &n_, const unsigned int &type_=0) const ;
+
+	/** Check that a buffer from the index is still present in the data file.
+	  * \param[in]  input_ The opened (mapped) data file.
+	  * \param[in]  index_ The position of the buffer in the index.
+	  * \return True if the buffer type word is found at the stored offset and false otherwise.
+	  */
+	bool verify(mappedFile &input_, const size_t &index_) const ;
+
+	/// Return the path of the sidecar index for a data file.
+	static std::string getSidecarName(const std::string &fname_){ return fname_+".idx"; }
+
+  private:
+	/// Identifies the version of the data file which was indexed.
+	struct fileStamp{
+		unsigned long long size; ///< Size of the data file in bytes.
+		long long time; ///< Modification time of the data file in seconds.
+		long long timeNsec; ///< Nanoseconds part of the modification time.
+		unsigned long long inode; ///< Inode number of the data file.
+
+		fileStamp() : size(0), time(0), timeNsec(0), inode(0) { }
+
+		bool operator == (const fileStamp &other_) const { return (size == other_.size && time == other_.time && timeNsec == other_.timeNsec && inode == other_.inode); }
+	};
+
+	fileStamp stamp; ///< The data file which was indexed.
+
+	std::vector<indexEntry> entries; ///< List of all buffers in the data file.
+
+	/// Get the size, modification time and inode number of the data file.
+	static bool stat(mappedFile &input_, fileStamp &stamp_);
+};
+
+#endif
@@ -0,0 +1,176 @@
+#ifndef BUFFER_SCAN_HPP
+#define BUFFER_SCAN_HPP
+
+#include <vector>
+#include <thread>
+
+#include "wordSearch.hpp"
+#include "byteSwap.hpp"
+
+#define HEAD 1145128264 // Run begin buffer
+#define DATA 1096040772 // Physics data buffer
+#define SCAL 1279345491 // Scaler type buffer
+#define DEAD 1145128260 // Deadtime buffer
+#define DIR 542263620   // "DIR "
+#define PAC 541278544   // "PAC "
+#define ENDFILE 541478725 // End of file buffer
+#define ENDBUFF -1 // End of buffer marker
+
+/// Length of an ldf buffer in 4 byte words (including the two word buffer header).
+const unsigned int ldfBufferLength = 8194;
+
+/// Number of known ldf buffer types.
+const unsigned int numBufferTypes = 7;
+
+/// List of the known ldf buffer type words.
+const unsigned int bufferTypes[numBufferTypes] = {HEAD, DATA, SCAL, DEAD, DIR, PAC, ENDFILE};
+
+/// List of the ascii names of the known ldf buffer types.
+const char * const bufferNames[numBufferTypes] = {"HEAD", "DATA", "SCAL", "DEAD", "DIR ", "PAC ", "EOF "};
+
+/** Return the index of a buffer type word in the list of known buffer types.
+  * \param[in]  word_ The buffer type word.
+  * \return The index of the buffer type, or -1 if the word is not a known buffer type.
+  */
+inline int getBufferTypeIndex(const unsigned int &word_){
+	for(unsigned int i = 0; i < numBufferTypes; i++){
+		if(word_ == bufferTypes[i]) return i;
+	}
+	return -1;
+}
+
+/// Return true if the word is one of the known ldf buffer types.
+inline bool isBufferHeader(const unsigned int &word_){
+	return (word_==HEAD || word_==DATA || word_==SCAL || word_==DEAD || word_==DIR || word_==PAC || word_==ENDFILE);
+}
+
+/// Location and length of a single ldf buffer.
+struct bufferInfo{
+	unsigned long long offset; ///< Word offset of the start of the buffer from the start of the span.
+	unsigned int type; ///< The buffer type word.
+	unsigned long long length; ///< Length of the buffer in words.
+
+	bufferInfo() : offset(0), type(0), length(0) { }
+
+	bufferInfo(const unsigned long long &offset_, const unsigned int &type_, const unsigned long long &length_) : offset(offset_), type(type_), length(length_) { }
+
+	/// Return true if the buffer has the expected ldf buffer length.
+	bool valid() const { return (length == ldfBufferLength); }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// class bufferScan
+///////////////////////////////////////////////////////////////////////////////
+
+/** Locates ldf buffers in a span of 32-bit words. A buffer is expected to start
+  * every ldfBufferLength words. When the word at the expected position is not a
+  * known buffer type, the span is searched for the next buffer type word and the
+  * preceding buffer is reported with its true (anomalous) length.
+  *
+  * The span may be split into chunks which are walked in parallel. Each chunk
+  * resynchronizes on the first buffer type word at or after the start of its
+  * chunk (chunks start on ldfBufferLength word boundaries). Since a buffer type
+  * word may also appear in the payload of a misaligned buffer, a chunk start is
+  * only kept if walking the previous chunk lands on it exactly, otherwise the
+  * chunk starts where that walk ended. Every buffer is therefore reported exactly
+  * once and the result does not depend on the number of chunks.
+  *
+  * The span may also be scanned in reversed byte order (for files written on
+  * big-endian systems). Buffer type words are then compared in the byte order of
+  * the span, and the types passed to callers are in native byte order.
+  */
+class bufferScan{
+  public:
+	/** Constructor.
+	  * \param[in]  words_  Pointer to the start of the span.
+	  * \param[in]  nWords_ The number of words in the span.
+	  * \param[in]  swap_   If set, the byte order of every word of the span is reversed.
+	  */
+	bufferScan(const unsigned int *words_, const size_t &nWords_, const bool &swap_=false);
+
+	/** Split the span into chunks and find the first buffer in each one.
+	  * \param[in]  nChunks_ The requested number of chunks.
+	  * \return The number of non-empty chunks.
+	  */
+	size_t split(const size_t &nChunks_);
+
+	/// Return the number of chunks.
+	size_t getNumChunks() const { return syncPoints.size(); }
+
+	/// Return the word offset of the first buffer in the span (equal to the span length if there are none).
+	size_t getFirstBuffer() const { return (syncPoints.empty() ? nWords : syncPoints.front()); }
+
+	/// Return the word offset of the end of a chunk (the first buffer of the following chunk).
+	size_t getChunkEnd(const size_t &chunk_) const { return (chunk_+1 < syncPoints.size() ? syncPoints[chunk_+1] : nWords); }
+
+	/// Return the number of words in the span.
+	size_t getNumWords() const { return nWords; }
+
+	/// Return a word of the span in native byte order.
+	unsigned int getWord(const size_t &pos_) const { return (swap ? byteSwap(words[pos_]) : words[pos_]); }
+
+	/** Return the word offset of the buffer which follows the buffer starting at pos_.
+	  * \param[in]  pos_  Word offset of the start of the current buffer.
+	  * \param[in]  stop_ Word offset at which to stop searching.
+	  * \return The word offset of the next buffer, or stop_ if none was found.
+	  */
+	size_t next(const size_t &pos_, const size_t &stop_) const ;
+
+	/** Walk all buffers in a chunk, calling func_(chunk_, buffer) for each one in file order.
+	  * \param[in]  chunk_ The index of the chunk.
+	  * \param[in]  func_  The function to call for each buffer.
+	  * \return Nothing.
+	  */
+	template <typename F>
+	void walk(const size_t &chunk_, F &func_) const {
+		const size_t stop = this->getChunkEnd(chunk_);
+		size_t pos = syncPoints[chunk_];
+		while(pos < stop){
+			size_t nextPos = this->next(pos, stop);
+			func_(chunk_, bufferInfo(pos, this->getWord(pos), nextPos-pos));
+			pos = nextPos;
+		}
+	}
+
+	/** Walk all buffers in the span using one thread per chunk. The function func_(chunk, buffer)
+	  * is called for each buffer. Buffers within a chunk are visited in file order, and every
+	  * buffer of a chunk comes before every buffer of the following chunk.
+	  * \param[in]  nThreads_ The number of threads to use.
+	  * \param[in]  func_     The function to call for each buffer.
+	  * \return The number of chunks which were walked.
+	  */
+	template <typename F>
+	size_t walkParallel(const size_t &nThreads_, F func_){
+		size_t nChunks = this->split(nThreads_);
+		if(nChunks <= 1){
+			if(nChunks == 1) this->walk(0, func_);
+			return nChunks;
+		}
+		std::vector<std::thread> workers;
+		for(size_t i = 0; i < nChunks; i++)
+			workers.push_back(std::thread([this, i, &func_](){ this->walk(i, func_); }));
+		for(size_t i = 0; i < nChunks; i++)
+			workers[i].join();
+		return nChunks;
+	}
+
+  private:
+	const unsigned int *words; ///< Pointer to the start of the span.
+
+	size_t nWords; ///< The number of words in the span.
+
+	bool swap; ///< Set to true if the byte order of the span is reversed.
+
+	wordSearch<unsigned int> headers; ///< Vectorized search for all known buffer types.
+
+	std::vector<size_t> syncPoints; ///< Word offset of the first buffer in each chunk.
+
+	/** Walk buffers from pos_ (without a search limit) until reaching or passing target_.
+	  * \param[in]  pos_    Word offset of the start of a buffer.
+	  * \param[in]  target_ Word offset at which to stop walking.
+	  * \return The word offset of the first buffer at or after target_.
+	  */
+	size_t land(size_t pos_, const size_t &target_) const ;
+};
+
+#endif
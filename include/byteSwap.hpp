@@ -0,0 +1,34 @@
+#ifndef BYTE_SWAP_HPP
+#define BYTE_SWAP_HPP
+
+#include <cstddef>
+
+/// Return a word with the order of its bytes reversed (single bytes are unchanged).
+inline unsigned char byteSwap(const unsigned char &word_){ return word_; }
+
+/// Return a word with the order of its bytes reversed.
+inline unsigned short byteSwap(const unsigned short &word_){ return __builtin_bswap16(word_); }
+
+/// Return a word with the order of its bytes reversed.
+inline unsigned int byteSwap(const unsigned int &word_){ return __builtin_bswap32(word_); }
+
+/// Return a word with the order of its bytes reversed.
+inline unsigned long long byteSwap(const unsigned long long &word_){ return __builtin_bswap64(word_); }
+
+/** Reverse the byte order of every word in an array using AVX2 (when supported by the
+  * cpu at runtime) or SSSE3 byte shuffles, with a scalar fallback for other architectures
+  * and for the tail of the array.
+  * \param[in]  src_  Pointer to the words to swap.
+  * \param[out] dest_ Pointer to an array of at least nWords_ words. May be equal to src_.
+  * \param[in]  nWords_ The number of words to swap.
+  * \return Nothing.
+  */
+template <typename T>
+void byteSwap(const T *src_, T *dest_, const size_t &nWords_);
+
+/** Return the name of the instruction set used by the vectorized byte swap.
+  * \return "avx2", "ssse3", or "scalar".
+  */
+const char *byteSwapInstructionSet();
+
+#endif
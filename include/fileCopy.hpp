@@ -0,0 +1,24 @@
+#ifndef FILE_COPY_HPP
+#define FILE_COPY_HPP
+
+/** Copy a range of bytes from one file to the current position of another without
+  * passing the data through user space where possible. Block aligned ranges are
+  * first cloned (reflinked) on filesystems which support it. Otherwise uses
+  * copy_file_range(), falling back to sendfile() and finally to pread() and write()
+  * if the kernel or filesystem does not support the faster methods.
+  * \param[in]  fdIn_    Descriptor of the source file.
+  * \param[in]  offset_  Byte offset of the start of the range in the source file.
+  * \param[in]  fdOut_   Descriptor of the destination file.
+  * \param[in]  length_  The number of bytes to copy.
+  * \return True if the entire range was copied and false otherwise.
+  */
+bool copyFileRange(const int &fdIn_, const unsigned long long &offset_, const int &fdOut_, const unsigned long long &length_);
+
+/** Check whether two descriptors refer to the same file (the same device and inode).
+  * \param[in]  fd1_ Descriptor of the first file.
+  * \param[in]  fd2_ Descriptor of the second file.
+  * \return True if both refer to the same file, or if either file could not be checked.
+  */
+bool isSameFile(const int &fd1_, const int &fd2_);
+
+#endif
@@ -0,0 +1,89 @@
+#ifndef FILE_FOLLOWER_HPP
+#define FILE_FOLLOWER_HPP
+
+#include <string>
+#include <vector>
+
+///////////////////////////////////////////////////////////////////////////////
+// class fileFollower
+///////////////////////////////////////////////////////////////////////////////
+
+/** Follows a file which is still being written by another process. Data which
+  * is appended to the file is read into a fixed size ring buffer, so that only
+  * new data is ever read. Changes to the file are detected with inotify where
+  * available, otherwise the file size is polled at a fixed interval.
+  */
+class fileFollower{
+  public:
+	/** Constructor.
+	  * \param[in]  capacity_ Size of the ring buffer in bytes (rounded up to a power of two).
+	  */
+	fileFollower(const size_t &capacity_=2097152);
+
+	/// Destructor.
+	~fileFollower();
+
+	/** Open a file and start following it from a given byte offset.
+	  * \param[in]  fname_  Path to the file.
+	  * \param[in]  offset_ Byte offset at which to start reading.
+	  * \return True if the file was opened successfully and false otherwise.
+	  */
+	bool open(const std::string &fname_, const unsigned long long &offset_);
+
+	/// Close the file.
+	void close();
+
+	/// Return true if changes to the file are detected using inotify and false if polling.
+	bool usingInotify() const { return (notifyFd >= 0); }
+
+	/** Wait until the file has been modified.
+	  * \param[in]  timeout_ Maximum time to wait in milliseconds.
+	  * \return True if the file was modified (or may have been, when polling) and false otherwise.
+	  */
+	bool wait(const int &timeout_);
+
+	/** Read any newly appended data into the ring buffer.
+	  * \return The number of bytes which were added to the ring buffer.
+	  */
+	size_t update();
+
+	/// Return the number of unread bytes in the ring buffer.
+	size_t available() const { return (size_t)(head-tail); }
+
+	/// Return true if the ring buffer is full.
+	bool full() const { return (head-tail == ring.size()); }
+
+	/// Return the file offset of the first unread byte in the ring buffer.
+	unsigned long long getOffset() const { return tail; }
+
+	/** Return a 32-bit word from the ring buffer without consuming it.
+	  * \param[in]  index_ Index of the word, relative to the first unread byte.
+	  * \return The word.
+	  */
+	unsigned int getWord(const size_t &index_) const ;
+
+	/** Copy bytes out of the ring buffer without consuming them.
+	  * \param[out] dest_ Pointer to an array of at least len_ bytes.
+	  * \param[in]  len_  The number of bytes to copy.
+	  * \return The number of bytes copied.
+	  */
+	size_t peek(char *dest_, const size_t &len_) const ;
+
+	/** Discard bytes from the front of the ring buffer.
+	  * \param[in]  len_ The number of bytes to discard.
+	  * \return Nothing.
+	  */
+	void consume(const size_t &len_);
+
+  private:
+	int fd; ///< Descriptor of the followed file.
+	int notifyFd; ///< Inotify descriptor (or -1 if polling).
+
+	std::vector<char> ring; ///< The ring buffer.
+	size_t mask; ///< Ring buffer index mask.
+
+	unsigned long long head; ///< File offset of the end of the data in the ring buffer.
+	unsigned long long tail; ///< File offset of the first unread byte in the ring buffer.
+};
+
+#endif
@@ -0,0 +1,101 @@
+#ifndef HEX_FORMATTER_HPP
+#define HEX_FORMATTER_HPP
+
+#include <string>
+#include <cstdio>
+
+/// Lookup table of the two uppercase hexadecimal digits for each byte value.
+extern const char hexDigitPairs[];
+
+/// Lookup table mapping each byte value to itself if alphanumeric, and to a space otherwise.
+extern const char asciiTable[256];
+
+///////////////////////////////////////////////////////////////////////////////
+// class hexFormatter
+///////////////////////////////////////////////////////////////////////////////
+
+/** Table driven formatter which renders data words as hexadecimal and ascii text
+  * directly into a large reusable output buffer. The buffer is written to the
+  * output file in large blocks whenever it fills up, or when flush() is called.
+  * No memory is allocated after construction.
+  */
+class hexFormatter{
+  public:
+	/** Constructor.
+	  * \param[in]  file_ The stream to write formatted output to.
+	  * \param[in]  size_ The size of the output buffer in bytes.
+	  */
+	hexFormatter(FILE *file_=stdout, const size_t &size_=4194304);
+
+	/// Destructor. Flushes any remaining output.
+	~hexFormatter();
+
+	/// Append a single character.
+	void put(const char &c_){
+		this->reserve(1);
+		buffer[index++] = c_;
+	}
+
+	/// Append a character array of known length.
+	void put(const char *str_, const size_t &len_);
+
+	/// Append a string.
+	void put(const std::string &str_){ this->put(str_.data(), str_.size()); }
+
+	/** Append a word as "0x" followed by two uppercase hex digits per byte, most significant byte first.
+	  * \param[in]  word_ The word to format.
+	  * \return Nothing.
+	  */
+	template <typename T>
+	void putHex(const T &word_){
+		this->reserve(2+2*sizeof(T));
+		char *ptr = buffer+index;
+		*ptr++ = '0';
+		*ptr++ = 'x';
+		for(int i = sizeof(T)-1; i >= 0; i--){
+			const char *pair = hexDigitPairs+2*((word_ >> (8*i)) & 0xFF);
+			*ptr++ = pair[0];
+			*ptr++ = pair[1];
+		}
+		index = ptr-buffer;
+	}
+
+	/** Append the bytes of a word in memory order, replacing non-alphanumeric characters with spaces.
+	  * \param[in]  word_ The word to format.
+	  * \return Nothing.
+	  */
+	template <typename T>
+	void putAscii(const T &word_){
+		this->reserve(sizeof(T));
+		const unsigned char *bytes = (const unsigned char*)&word_;
+		for(size_t i = 0; i < sizeof(T); i++)
+			buffer[index++] = asciiTable[bytes[i]];
+	}
+
+	/** Append an unsigned decimal integer, padded on the left to a minimum width.
+	  * \param[in]  val_   The value to format.
+	  * \param[in]  width_ The minimum number of characters.
+	  * \param[in]  fill_  The padding character.
+	  * \return Nothing.
+	  */
+	void putDecimal(unsigned long long val_, const size_t &width_=0, const char &fill_='0');
+
+	/// Write the contents of the output buffer to the output file.
+	void flush();
+
+  private:
+	FILE *file; ///< The output stream.
+
+	char *buffer; ///< The output buffer.
+
+	size_t size; ///< The size of the output buffer in bytes.
+
+	size_t index; ///< The number of bytes currently in the output buffer.
+
+	/// Make room for at least len_ bytes in the output buffer, flushing it if necessary.
+	void reserve(const size_t &len_){
+		if(index+len_ > size) this->flush();
+	}
+};
+
+#endif
@@ -0,0 +1,107 @@
+#ifndef HEX_PAGER_HPP
+#define HEX_PAGER_HPP
+
+#include <string>
+#include <vector>
+
+#include "hexFormatter.hpp"
+#include "bufferScan.hpp"
+
+class mappedFile;
+
+///////////////////////////////////////////////////////////////////////////////
+// class hexPager
+///////////////////////////////////////////////////////////////////////////////
+
+/** Interactive full screen viewer for a memory mapped data file. Only the words
+  * which are visible on the screen are ever rendered, so the cost of redrawing
+  * the screen does not depend on the size of the file. Supports jumping to an
+  * arbitrary word offset, stepping between buffers (optionally of a single type)
+  * and searching forward for one or more word values.
+  */
+class hexPager{
+  public:
+	/** Constructor.
+	  * \param[in]  input_   The opened data file. Must be mapped.
+	  * \param[in]  convert_ Display the ascii representation of each word.
+	  */
+	hexPager(mappedFile &input_, const bool &convert_=false);
+
+	/// Destructor. Restores the terminal if it is still in raw mode.
+	~hexPager();
+
+	/** Set the buffer type which is used when stepping between buffers.
+	  * \param[in]  type_ The buffer type word. Buffers of any type are used if this is zero.
+	  * \return Nothing.
+	  */
+	void setBufferType(const unsigned int &type_){ bufferType = type_; }
+
+	/** Run the viewer until the user quits.
+	  * \param[in]  start_ Word offset of the first word to display.
+	  * \return True upon success and false if the terminal could not be configured.
+	  */
+	bool run(const unsigned long long &start_);
+
+  private:
+	const unsigned int *words; ///< Pointer to the start of the mapped file.
+	size_t nWords; ///< The number of words in the file.
+
+	size_t top; ///< Word offset of the first displayed word.
+	size_t rows; ///< Number of rows of words on the screen.
+	size_t columns; ///< Number of words displayed on each row.
+	bool convert; ///< Set to true if the ascii representation of words is displayed.
+
+	unsigned int bufferType; ///< Buffer type word used when stepping between buffers (zero for any).
+	std::vector<unsigned int> searchValues; ///< The values of the most recent search.
+
+	std::string message; ///< Message displayed on the status line.
+
+	hexFormatter output; ///< Formatter used to render the screen.
+
+	bufferScan scanner; ///< Used to step from one buffer to the next.
+
+	/** Put the terminal into raw (non-canonical, no echo, no keyboard signals) mode and switch
+	  * to the alternate screen. Terminating signals and exit() restore the terminal, and the
+	  * viewer may be suspended and continued.
+	  */
+	bool enterRawMode();
+
+	/// Return to the normal screen and restore the original terminal settings and signal handlers.
+	void leaveRawMode();
+
+	/// Query the terminal size and compute the screen layout.
+	void updateLayout();
+
+	/// Clamp the top of the screen to the valid range of word offsets.
+	void clampTop();
+
+	/// Redraw the screen.
+	void render();
+
+	/// Block until a key is pressed and return its code.
+	int readKey();
+
+	/** Display a prompt on the status line and read a line of input.
+	  * \param[in]  text_ The prompt text.
+	  * \return The text entered by the user (empty if the prompt was cancelled).
+	  */
+	std::string prompt(const std::string &text_);
+
+	/** Return the word offset of the start of the buffer containing a word.
+	  * Only the preceding ldfBufferLength words are searched.
+	  * \param[in]  pos_ The word offset.
+	  * \return The word offset of the buffer header, or nWords if none was found.
+	  */
+	size_t findBufferStart(const size_t &pos_) const ;
+
+	/// Move the top of the screen to the start of the next buffer of the selected type.
+	bool nextBuffer();
+
+	/// Move the top of the screen to the start of the previous buffer of the selected type.
+	bool previousBuffer();
+
+	/// Move the top of the screen to the next occurrence of any of the search values.
+	bool searchForward();
+};
+
+#endif
@@ -0,0 +1,90 @@
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+
+#include <string>
+
+///////////////////////////////////////////////////////////////////////////////
+// class mappedFile
+///////////////////////////////////////////////////////////////////////////////
+
+/** A read-only view of a binary data file. Regular files are mapped into
+  * memory so that the entire file may be walked as a contiguous span of words.
+  * Inputs which cannot be mapped (pipes, fifos, stdin) fall back to streaming
+  * the file in large blocks using read().
+  */
+class mappedFile{
+  public:
+	/// Default constructor.
+	mappedFile();
+
+	/// Destructor.
+	~mappedFile();
+
+	/** Open a file for reading and attempt to map it into memory.
+	  * \param[in]  fname_ Path to the input file. Use "-" to read from stdin.
+	  * \return True if the file was opened successfully and false otherwise.
+	  */
+	bool open(const std::string &fname_);
+
+	/** Unmap and close the file.
+	  * \return Nothing.
+	  */
+	void close();
+
+	/// Return true if a file is currently open.
+	bool isOpen() const { return (fd >= 0); }
+
+	/// Return true if the file is mapped into memory and false if it must be streamed.
+	bool isMapped() const { return (data != NULL); }
+
+	/// Return a pointer to the start of the mapped file (NULL if not mapped).
+	const char *getData() const { return data; }
+
+	/// Return the length of the mapped file in bytes (zero if not mapped).
+	size_t getSize() const { return length; }
+
+	/// Return the file descriptor of the open file.
+	int getDescriptor() const { return fd; }
+
+	/** Tell the kernel that the mapped file will be accessed at random (e.g. by an interactive
+	  * viewer) instead of from beginning to end, so that it does not read ahead.
+	  * \return Nothing.
+	  */
+	void setRandomAccess();
+
+	/** Read the next block of bytes from a streamed file.
+	  * \param[out] dest_ Pointer to an array of at least len_ bytes.
+	  * \param[in]  len_  Maximum number of bytes to read.
+	  * \return The number of bytes read. Returns zero at the end of the stream.
+	  */
+	size_t read(char *dest_, const size_t &len_);
+
+	/** Read a block of bytes from an arbitrary position of a seekable file with pread(),
+	  * without touching the memory map or the current file position.
+	  * \param[out] dest_   Pointer to an array of at least len_ bytes.
+	  * \param[in]  len_    Maximum number of bytes to read.
+	  * \param[in]  offset_ Byte offset in the file at which to start reading.
+	  * \return The number of bytes read. Returns zero at the end of the file or upon error.
+	  */
+	size_t readAt(char *dest_, const size_t &len_, const unsigned long long &offset_) const ;
+
+	/// Return the size of the open file in bytes, or zero if it is not a regular file.
+	unsigned long long getFileSize() const ;
+
+	/** Skip forward in a streamed file by reading and discarding data.
+	  * \param[in]  nBytes_ The number of bytes to skip.
+	  * \return True if the requested number of bytes were skipped and false otherwise.
+	  */
+	bool skip(const unsigned long long &nBytes_);
+
+  private:
+	int fd; ///< Descriptor of the open file.
+
+	bool ownDescriptor; ///< Set to true if the descriptor should be closed by close().
+
+	char *data; ///< Pointer to the start of the memory map.
+
+	size_t length; ///< Length of the memory map in bytes.
+};
+
+#endif
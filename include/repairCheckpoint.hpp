@@ -0,0 +1,92 @@
+#ifndef REPAIR_CHECKPOINT_HPP
+#define REPAIR_CHECKPOINT_HPP
+
+#include <string>
+#include <vector>
+
+#include "bufferScan.hpp"
+
+/** State of a streaming repair which allows an interrupted repair to be resumed.
+  * The checkpoint is stored in a sidecar file next to the output file
+  * (<filename>.ckpt) along with the size, modification time (in nanoseconds) and
+  * inode number of the input file, so that a checkpoint is never applied to a
+  * different (or modified) input file.
+  * Every checkpoint marks a buffer boundary of the input file, and all output up
+  * to the output offset has been written to disk before the checkpoint is saved.
+  * A hash of the last block of output before the output offset is also stored, so
+  * that a missing, truncated or modified output file is detected before resuming.
+  */
+struct repairCheckpoint{
+	unsigned long long inputSize; ///< Size of the input file in bytes.
+	long long inputTime; ///< Modification time of the input file in seconds.
+	long long inputTimeNsec; ///< Nanoseconds part of the modification time of the input file.
+	unsigned long long inputInode; ///< Inode number of the input file.
+
+	unsigned long long inputOffset; ///< Byte offset in the input file at which to resume.
+	unsigned long long outputOffset; ///< Length of the valid part of the output file in bytes.
+	unsigned long long interval; ///< Number of input bytes between checkpoints.
+
+	unsigned long long outputHash; ///< Hash of the last block of output before the output offset.
+
+	unsigned long long numBuffers; ///< Number of buffers processed so far.
+	unsigned long long numBadBuffers; ///< Number of invalid buffers found so far.
+	unsigned long long numRepaired; ///< Number of invalid buffers repaired so far.
+
+	std::vector<bufferInfo> anomalies; ///< The invalid buffers found so far (offsets in words from the start of the input file).
+
+	repairCheckpoint() : inputSize(0), inputTime(0), inputTimeNsec(0), inputInode(0), inputOffset(0), outputOffset(0), interval(0), outputHash(0), numBuffers(0), numBadBuffers(0), numRepaired(0) { }
+
+	/** Record the size, modification time and inode number of the input file.
+	  * \param[in]  fd_ Descriptor of the input file.
+	  * \return True upon success and false if the input is not a regular file.
+	  */
+	bool setInput(const int &fd_);
+
+	/** Check that the checkpoint belongs to an input file.
+	  * \param[in]  fd_ Descriptor of the input file.
+	  * \return True if the size, modification time and inode number of the input file are unchanged.
+	  */
+	bool matches(const int &fd_) const ;
+
+	/** Set the output offset and hash the last block of output preceding it. All output up to
+	  * the offset must already have been written.
+	  * \param[in]  fd_     Descriptor of the output file (opened for reading).
+	  * \param[in]  offset_ Length of the valid part of the output file in bytes.
+	  * \return True upon success and false if the output file could not be read.
+	  */
+	bool setOutput(const int &fd_, const unsigned long long &offset_);
+
+	/** Check that the output file still holds the output recorded by the checkpoint.
+	  * \param[in]  fd_ Descriptor of the output file (opened for reading).
+	  * \return True if the output file is at least outputOffset bytes long and the hash of its last block matches.
+	  */
+	bool matchesOutput(const int &fd_) const ;
+
+	/** Read a checkpoint file.
+	  * \param[in]  fname_ Path to the checkpoint file.
+	  * \return True if the checkpoint was read successfully and false otherwise.
+	  */
+	bool read(const std::string &fname_);
+
+	/** Write the checkpoint to a temporary file and rename it, so that an interruption
+	  * never leaves a partially written checkpoint behind. All fields are written
+	  * explicitly in little-endian byte order following a magic word and version.
+	  * \param[in]  fname_ Path to the checkpoint file.
+	  * \return True upon success and false otherwise.
+	  */
+	bool write(const std::string &fname_) const ;
+
+	/// Return the path of the checkpoint for an output file.
+	static std::string getSidecarName(const std::string &fname_){ return fname_+".ckpt"; }
+
+  private:
+	/** Hash the block of output preceding an output offset.
+	  * \param[in]  fd_     Descriptor of the output file.
+	  * \param[in]  offset_ Byte offset of the end of the block.
+	  * \param[out] hash_   The hash of the block.
+	  * \return True upon success and false if the block could not be read.
+	  */
+	static bool hashOutput(const int &fd_, const unsigned long long &offset_, unsigned long long &hash_);
+};
+
+#endif
@@ -0,0 +1,209 @@
+#ifndef SPILL_READER_HPP
+#define SPILL_READER_HPP
+
+#include <vector>
+#include <cstddef>
+
+#include "HelperEnumerations.hpp"
+
+/// Vsn of the end of spill marker module.
+const unsigned int endOfSpillVsn = 9999;
+
+/// Vsn of the superheavy (RAM dump) module.
+const unsigned int superheavyVsn = 1000;
+
+///////////////////////////////////////////////////////////////////////////////
+// struct channelHeaders
+///////////////////////////////////////////////////////////////////////////////
+
+/** A batch of decoded Pixie16 list mode channel headers, stored as one array per
+  * field so that the fields of an entire module can be extracted in tight loops.
+  */
+struct channelHeaders{
+	std::vector<unsigned int> word0; ///< First word of each header (ids and lengths).
+	std::vector<unsigned int> word1; ///< Second word of each header (low time bits).
+	std::vector<unsigned int> word2; ///< Third word of each header (high time bits and cfd).
+	std::vector<unsigned int> word3; ///< Fourth word of each header (energy and trace length).
+
+	std::vector<unsigned char> channel; ///< Channel number.
+	std::vector<unsigned char> slot; ///< Slot number.
+	std::vector<unsigned char> crate; ///< Crate number.
+	std::vector<unsigned char> headerLength; ///< Header length in words.
+	std::vector<unsigned short> eventLength; ///< Event length in words (header plus trace).
+	std::vector<unsigned short> energy; ///< Trapezoidal filter energy.
+	std::vector<unsigned short> traceLength; ///< Trace length in adc samples.
+	std::vector<unsigned short> cfdTime; ///< Cfd fractional time.
+	std::vector<unsigned long long> time; ///< 48-bit event time.
+	std::vector<unsigned char> pileup; ///< Finish code (pileup) flag.
+	std::vector<unsigned char> saturated; ///< Trace out-of-range flag.
+
+	/// Return the number of headers in the batch.
+	size_t size() const { return word0.size(); }
+
+	/// Remove all headers from the batch.
+	void clear();
+
+	/** Locate every channel header in the data of a single module and extract all header fields.
+	  * \param[in]  data_   Pointer to the module data (after the module length and vsn words).
+	  * \param[in]  nWords_ The number of words of module data.
+	  * \return True if the module data was consumed exactly and false if an event length was invalid.
+	  */
+	bool decode(const unsigned int *data_, const size_t &nWords_);
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// class spillReader
+///////////////////////////////////////////////////////////////////////////////
+
+/** Reassembles spills from the chunks of consecutive ldf DATA buffers. Each chunk
+  * begins with a three word header (chunk size in bytes, total number of chunks
+  * in the spill, and chunk number). The final chunk of every spill is a five word
+  * spill footer. Chunks which are inconsistent with the spill being assembled
+  * cause the spill to be discarded.
+  */
+class spillReader{
+  public:
+	/// Possible framing errors found while reading DATA buffers.
+	enum STATUS {OK, BAD_CHUNK_SIZE, BAD_CHUNK_NUMBER, BAD_CHUNK_COUNT, MISSING_CHUNKS, BAD_FOOTER, NUM_STATUS};
+
+	/// Default constructor.
+	spillReader(){ this->reset(); }
+
+	/// Discard any partial spill and reset all counters.
+	void reset();
+
+	/** Read the chunks of a single DATA buffer. Calls spillFunc_(spill) every time a spill
+	  * is completed and errorFunc_(status, index) for every framing error, where index is
+	  * the position of the offending chunk header in the buffer.
+	  * \param[in]  words_   Pointer to the start of the buffer (the DATA word).
+	  * \param[in]  length_  Length of the buffer in words.
+	  * \param[in]  start_   Position of the first chunk header to read (after the buffer type and size words by default).
+	  * \return The number of framing errors found in the buffer.
+	  */
+	template <typename F, typename E>
+	int read(const unsigned int *words_, const size_t &length_, F spillFunc_, E errorFunc_, const size_t &start_=2){
+		int nErrors = 0;
+		size_t pos = start_;
+		while(pos+3 <= length_ && words_[pos] != 0xFFFFFFFF){
+			const unsigned int chunkSize = words_[pos]/4;
+			const unsigned int totalChunks = words_[pos+1];
+			const unsigned int chunkNum = words_[pos+2];
+
+			// A bad chunk size leaves us unable to find the next chunk in this buffer.
+			if(words_[pos] % 4 != 0 || chunkSize < 3 || pos+chunkSize > length_){
+				errorFunc_(BAD_CHUNK_SIZE, pos);
+				nErrors++;
+				numErrors++;
+				inSpill = false;
+				break;
+			}
+
+			STATUS status = OK;
+			if(chunkNum == 0){ // First chunk of a new spill.
+				if(inSpill) status = MISSING_CHUNKS;
+				spill.clear();
+				inSpill = true;
+				spillBuffer = words_;
+				spillPos = pos;
+				numStarted++;
+				numChunks = totalChunks;
+				nextChunk = 0;
+			}
+			else if(!inSpill){ status = BAD_CHUNK_NUMBER; }
+			else if(totalChunks != numChunks){ status = BAD_CHUNK_COUNT; }
+			else if(chunkNum != nextChunk){ status = (chunkNum > nextChunk ? MISSING_CHUNKS : BAD_CHUNK_NUMBER); }
+
+			if(status != OK){
+				errorFunc_(status, pos);
+				nErrors++;
+				numErrors++;
+				if(chunkNum != 0){ // Discard the rest of this spill.
+					inSpill = false;
+					pos += chunkSize;
+					continue;
+				}
+			}
+
+			if(chunkNum+1 == numChunks){ // Spill footer.
+				if(chunkSize != 5){
+					errorFunc_(BAD_FOOTER, pos);
+					nErrors++;
+					numErrors++;
+				}
+				else{
+					spill.insert(spill.end(), words_+pos+3, words_+pos+chunkSize);
+					spillFunc_(spill);
+					numSpills++;
+				}
+				inSpill = false;
+			}
+			else{
+				spill.insert(spill.end(), words_+pos+3, words_+pos+chunkSize);
+				nextChunk++;
+			}
+
+			pos += chunkSize;
+		}
+		return nErrors;
+	}
+
+	/// Return true if a spill is currently being assembled.
+	bool inProgress() const { return inSpill; }
+
+	/// Return the number of spills completed so far.
+	unsigned long long getNumSpills() const { return numSpills; }
+
+	/// Return the number of spills started so far (the number of chunks with chunk number zero).
+	unsigned long long getNumStarted() const { return numStarted; }
+
+	/// Return the number of framing errors found so far.
+	unsigned long long getNumErrors() const { return numErrors; }
+
+	/** Return the location of the first chunk of the current (or most recently started) spill.
+	  * \param[out] pos_ Position of the first chunk header within its buffer.
+	  * \return Pointer to the start of the buffer containing the first chunk, or NULL if no spill was started.
+	  */
+	const unsigned int *getSpillStart(size_t &pos_) const {
+		pos_ = spillPos;
+		return spillBuffer;
+	}
+
+	/// Return a short description of a status code.
+	static const char *getStatusName(const STATUS &status_);
+
+	/** Walk the module records of a complete spill. Calls func_(vsn, data, nWords) for the
+	  * data of every non-empty module. Stops at the end of spill marker.
+	  * \param[in]  spill_ The spill data.
+	  * \param[in]  func_  The function to call for each module.
+	  * \return True if the module records exactly span the spill and false otherwise.
+	  */
+	template <typename F>
+	static bool forEachModule(const std::vector<unsigned int> &spill_, F func_){
+		size_t pos = 0;
+		while(pos+2 <= spill_.size()){
+			const unsigned int lenRec = spill_[pos];
+			const unsigned int vsn = spill_[pos+1];
+			if(lenRec < 2 || pos+lenRec > spill_.size()) return false;
+			if(vsn == endOfSpillVsn) return (pos+lenRec == spill_.size());
+			if(vsn != superheavyVsn && lenRec > 2) func_(vsn, spill_.data()+pos+2, lenRec-2);
+			pos += lenRec;
+		}
+		return (pos == spill_.size());
+	}
+
+  private:
+	std::vector<unsigned int> spill; ///< The spill being assembled.
+
+	bool inSpill; ///< Set to true while a spill is being assembled.
+	unsigned int numChunks; ///< Total number of chunks in the current spill.
+	unsigned int nextChunk; ///< Expected number of the next chunk.
+
+	const unsigned int *spillBuffer; ///< Buffer containing the first chunk of the current spill.
+	size_t spillPos; ///< Position of the first chunk header of the current spill.
+
+	unsigned long long numSpills; ///< Number of spills completed.
+	unsigned long long numStarted; ///< Number of spills started.
+	unsigned long long numErrors; ///< Number of framing errors found.
+};
+
+#endif
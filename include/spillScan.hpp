@@ -0,0 +1,169 @@
+#ifndef SPILL_SCAN_HPP
+#define SPILL_SCAN_HPP
+
+#include <vector>
+
+#include "bufferScan.hpp"
+#include "spillReader.hpp"
+
+/** Return the position of the first chunk header of a DATA buffer which starts a spill (chunk number zero).
+  * \param[in]  words_  Pointer to the start of the buffer.
+  * \param[in]  length_ Length of the buffer in words.
+  * \return The position of the chunk header, or length_ if none was found.
+  */
+size_t findSpillStart(const unsigned int *words_, const size_t &length_);
+
+/// Location of the first chunk of a spill.
+struct spillStart{
+	unsigned long long offset; ///< Word offset of the DATA buffer containing the first chunk.
+	size_t pos; ///< Position of the first chunk header within the buffer.
+
+	spillStart() : offset(0), pos(0) { }
+
+	spillStart(const unsigned long long &offset_, const size_t &pos_) : offset(offset_), pos(pos_) { }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// class spillScan
+///////////////////////////////////////////////////////////////////////////////
+
+/** Reassembles the spills of all DATA buffers in a span of words using multiple
+  * threads. Each thread walks one chunk of the span (see bufferScan). Every thread
+  * after the first starts reading at the first spill which begins in its chunk.
+  * The chunks preceding that spill are then read in file order, continuing with
+  * the state of the previous chunk, so the spills and framing errors found are
+  * exactly those of a single spillReader reading the entire span.
+  *
+  * Results are reported per slot. Slot 2*i holds the chunks read after the main
+  * pass (the end of the spill which straddles the start of chunk i) and slot 2*i+1
+  * holds the rest of chunk i, so the slots are in file order. Spill indices passed
+  * to the callbacks must be converted with getSpillIndex() once read() returns.
+  */
+class spillScan{
+  public:
+	/** Constructor.
+	  * \param[in]  words_  Pointer to the start of the span.
+	  * \param[in]  nWords_ The number of words in the span.
+	  */
+	spillScan(const unsigned int *words_, const size_t &nWords_) : words(words_), nWords(nWords_), scanner(words_, nWords_) { }
+
+	/** Read all spills. Calls bufferFunc_(chunk, buffer) from the worker threads for every buffer
+	  * of any type, spillFunc_(slot, index, offset, start, spill) for every completed spill and
+	  * errorFunc_(slot, index, offset, status) for every framing error, where offset is the
+	  * word offset of the buffer which completed the spill or of the offending chunk header
+	  * and start is the location of the first chunk of the spill (see readSpill()).
+	  * The callbacks for different slots may be called concurrently.
+	  * \param[in]  nThreads_ The number of threads to use.
+	  * \return The number of chunks which were read.
+	  */
+	template <typename B, typename F, typename E>
+	size_t read(const unsigned int &nThreads_, B bufferFunc_, F spillFunc_, E errorFunc_){
+		workers.assign(nThreads_ > 0 ? nThreads_ : 1, worker());
+
+		size_t nChunks = scanner.walkParallel(nThreads_, [&](const size_t &chunk_, const bufferInfo &buff_){
+			bufferFunc_(chunk_, buff_);
+			if(buff_.type != DATA) return;
+			worker &local = workers[chunk_];
+			size_t start = 2;
+			if(!local.synced && chunk_ > 0){ // Skip the end of the spill which began in the previous chunk.
+				start = findSpillStart(words+buff_.offset, buff_.length);
+				if(start >= buff_.length) return;
+				local.synced = true;
+				local.syncOffset = buff_.offset;
+				local.syncPos = start;
+			}
+			this->readBuffer(local.reader, 2*chunk_+1, buff_.offset, buff_.length, start, -1, spillFunc_, errorFunc_);
+		});
+		workers.resize(nChunks);
+
+		// Read the chunks preceding the first spill of each chunk in file order. A chunk without
+		// the start of a spill is read entirely and passes its state on to the next chunk.
+		firstSpill.assign(nChunks+1, 0);
+		for(size_t i = 0; i < nChunks; i++){
+			if(i > 0){
+				worker &local = workers[i];
+				spillReader reader = workers[i-1].reader;
+				const long long current = (long long)firstSpill[i]-1;
+				size_t pos = scanner.getChunkEnd(i-1);
+				const size_t stop = scanner.getChunkEnd(i);
+				while(pos < stop){
+					size_t nextPos = scanner.next(pos, stop);
+					if(words[pos] == DATA){
+						const bool last = (local.synced && pos == local.syncOffset);
+						this->readBuffer(reader, 2*i, pos, (last ? local.syncPos : nextPos-pos), 2, current, spillFunc_, errorFunc_);
+						if(last) break;
+					}
+					pos = nextPos;
+				}
+				if(!local.synced) local.reader = reader;
+				else if(reader.inProgress()) // The spill is interrupted by the first spill of this chunk.
+					errorFunc_(2*i, current, local.syncOffset+local.syncPos, spillReader::MISSING_CHUNKS);
+			}
+			firstSpill[i+1] = firstSpill[i]+(i == 0 || workers[i].synced ? workers[i].reader.getNumStarted() : 0);
+		}
+
+		return nChunks;
+	}
+
+	/// Return the number of result slots.
+	size_t getNumSlots() const { return 2*workers.size(); }
+
+	/// Convert a spill index passed to a callback for a slot into the index of the spill in the span (-1 for chunks preceding the first spill).
+	long long getSpillIndex(const size_t &slot_, const long long &index_) const { return (slot_ % 2 == 1 ? (long long)firstSpill[slot_/2]+index_ : index_); }
+
+	/// Return the number of spills started in the span.
+	unsigned long long getNumSpills() const { return (firstSpill.empty() ? 0 : firstSpill.back()); }
+
+	/// Return the number of words in the span.
+	size_t getNumWords() const { return nWords; }
+
+	/** Reassemble a single spill from the location of its first chunk.
+	  * \param[in]  start_ Location of the first chunk of the spill.
+	  * \param[out] spill_ The spill data.
+	  * \return True if the spill was completed and false otherwise.
+	  */
+	bool readSpill(const spillStart &start_, std::vector<unsigned int> &spill_) const;
+
+  private:
+	/// Spill reading state of a single chunk.
+	struct worker{
+		spillReader reader; ///< Reassembles the spills of the chunk.
+		bool synced; ///< Set to true once the start of a spill has been found.
+		unsigned long long syncOffset; ///< Word offset of the DATA buffer containing the first spill start.
+		size_t syncPos; ///< Position of the first spill start within its buffer.
+
+		worker() : synced(false), syncOffset(0), syncPos(0) { }
+	};
+
+	const unsigned int *words; ///< Pointer to the start of the span.
+
+	size_t nWords; ///< The number of words in the span.
+
+	bufferScan scanner; ///< Splits the span into chunks and locates buffers.
+
+	std::vector<worker> workers; ///< The state of each chunk.
+
+	std::vector<unsigned long long> firstSpill; ///< Index of the first spill started in each chunk.
+
+	/** Read the chunks of a DATA buffer. The spill index passed to the callbacks is relative to the
+	  * first spill of the reader, or fixed to fixedSpill_ if it is non-negative.
+	  */
+	template <typename F, typename E>
+	void readBuffer(spillReader &reader_, const size_t &slot_, const unsigned long long &offset_, const size_t &length_, const size_t &start_, const long long &fixedSpill_, F &spillFunc_, E &errorFunc_){
+		const unsigned int *buff = words+offset_;
+		auto spillIndex = [&](const int &back_) -> long long {
+			return (fixedSpill_ >= 0 ? fixedSpill_ : (long long)reader_.getNumStarted()-back_);
+		};
+		reader_.read(buff, length_, [&](const std::vector<unsigned int> &spill_){
+			size_t pos;
+			const unsigned int *first = reader_.getSpillStart(pos);
+			spillFunc_(slot_, spillIndex(1), offset_, spillStart(first-words, pos), spill_);
+		}, [&](const spillReader::STATUS &status_, const size_t &pos_){
+			// A new spill which interrupts an incomplete one damages the previous spill.
+			const int back = (status_ == spillReader::MISSING_CHUNKS && buff[pos_+2] == 0 ? 2 : 1);
+			errorFunc_(slot_, spillIndex(back), offset_+pos_, status_);
+		}, start_);
+	}
+};
+
+#endif
@@ -0,0 +1,16 @@
+#ifndef WORD_HASH_HPP
+#define WORD_HASH_HPP
+
+#include <cstddef>
+
+/** Compute a fast 64-bit non-cryptographic hash (xxHash64) of a block of 32-bit words.
+  * Four independent accumulators are updated with 64-bit multiply and rotate rounds,
+  * so the hash of a large block is limited by memory bandwidth rather than latency.
+  * \param[in]  words_  Pointer to the words to hash.
+  * \param[in]  nWords_ The number of words to hash.
+  * \param[in]  seed_   Seed value of the hash.
+  * \return The 64-bit hash of the words.
+  */
+unsigned long long hashWords(const unsigned int *words_, const size_t &nWords_, const unsigned long long &seed_=0);
+
+#endif
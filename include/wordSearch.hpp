@@ -0,0 +1,110 @@
+#ifndef WORD_SEARCH_HPP
+#define WORD_SEARCH_HPP
+
+#include <vector>
+#include <cstddef>
+
+///////////////////////////////////////////////////////////////////////////////
+// class wordSearch
+///////////////////////////////////////////////////////////////////////////////
+
+/** Vectorized search for several needle words at once in a span of words of type T.
+  * Each block of the input is compared against every needle in a single pass using
+  * AVX2 (when supported by the cpu at runtime) or SSE2, with a scalar fallback for
+  * other architectures and for the tail of the input.
+  */
+template <typename T>
+class wordSearch{
+  public:
+	/// Maximum number of needles which may be searched for simultaneously.
+	static const size_t maxNeedles = 16;
+
+	/// Default constructor.
+	wordSearch(){ }
+
+	/// Constructor taking a list of needles.
+	wordSearch(const std::vector<T> &needles_);
+
+	/** Add a needle to the list of words to search for.
+	  * \param[in]  needle_ The word to search for.
+	  * \return True if the needle was added and false if the list is already full.
+	  */
+	bool add(const T &needle_);
+
+	/// Return the number of needles.
+	size_t getNumNeedles() const { return needles.size(); }
+
+	/// Return the list of needles.
+	const std::vector<T> &getNeedles() const { return needles; }
+
+	/// Return the number of words in a match (always one).
+	size_t getLength() const { return 1; }
+
+	/** Find the first word in the range [begin_, end_) which matches any of the needles.
+	  * \param[in]  begin_ Pointer to the first word of the range.
+	  * \param[in]  end_   Pointer to one past the last word of the range.
+	  * \return Pointer to the first matching word, or end_ if no match was found.
+	  */
+	const T *find(const T *begin_, const T *end_) const ;
+
+  private:
+	std::vector<T> needles; ///< List of words to search for.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// class sequenceSearch
+///////////////////////////////////////////////////////////////////////////////
+
+/** Vectorized search for a sequence of consecutive words of type T, where each word
+  * of the sequence is compared under its own bit mask. A word with a mask of zero is
+  * a wildcard which matches anything. The word of the sequence with the most mask
+  * bits set is used as the anchor, which is located with a vectorized masked compare.
+  * The remaining words of the sequence are only checked at candidate positions.
+  */
+template <typename T>
+class sequenceSearch{
+  public:
+	/// Default constructor.
+	sequenceSearch() : anchor(0) { }
+
+	/** Append a word to the end of the sequence.
+	  * \param[in]  value_ The value of the word. Only the bits set in mask_ are used.
+	  * \param[in]  mask_  The bit mask of the word. Use zero for a wildcard.
+	  * \return Nothing.
+	  */
+	void add(const T &value_, const T &mask_=(T)(-1));
+
+	/// Return the number of words in the sequence.
+	size_t getLength() const { return values.size(); }
+
+	/** Check for a match of the entire sequence.
+	  * \param[in]  ptr_ Pointer to the first of at least getLength() words.
+	  * \return True if the sequence matches and false otherwise.
+	  */
+	bool match(const T *ptr_) const {
+		for(size_t i = 0; i < values.size(); i++){
+			if((ptr_[i] & masks[i]) != values[i]) return false;
+		}
+		return true;
+	}
+
+	/** Find the first complete match of the sequence in the range [begin_, end_).
+	  * \param[in]  begin_ Pointer to the first word of the range.
+	  * \param[in]  end_   Pointer to one past the last word of the range.
+	  * \return Pointer to the first word of the match, or end_ if no match was found.
+	  */
+	const T *find(const T *begin_, const T *end_) const ;
+
+  private:
+	std::vector<T> values; ///< The masked value of each word in the sequence.
+	std::vector<T> masks; ///< The bit mask of each word in the sequence.
+
+	size_t anchor; ///< Index of the most selective word of the sequence.
+};
+
+/** Return the name of the instruction set used by the vectorized word search.
+  * \return "avx2", "sse2", or "scalar".
+  */
+const char *wordSearchInstructionSet();
+
+#endif
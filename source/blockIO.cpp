@@ -0,0 +1,227 @@
+/** \file blockIO.cpp
+  * \brief Double buffered sequential file reading and writing.
+  *
+  * \author C. R. Thornsberry
+  * \date Oct. 16th, 2026
+  */
+
+#include <string.h>
+
+#include <unistd.h>
+#include <errno.h>
+
+#include "blockIO.hpp"
+
+///////////////////////////////////////////////////////////////////////////////
+// class blockReader
+///////////////////////////////////////////////////////////////////////////////
+
+blockReader::blockReader(const size_t &blockSize_/*=16777216*/) : current(-1), finished(false), running(false), failed(false) {
+	for(int i = 0; i < 2; i++){
+		blocks[i].resize(blockSize_);
+		lengths[i] = 0;
+		filled[i] = false;
+	}
+}
+
+blockReader::~blockReader(){
+	this->stop();
+}
+
+bool blockReader::start(const int &fd_, const unsigned long long &offset_/*=0*/){
+	if(running) return false;
+	for(int i = 0; i < 2; i++){
+		lengths[i] = 0;
+		filled[i] = false;
+	}
+	current = -1;
+	finished = false;
+	failed = false;
+	running = true;
+	worker = std::thread(&blockReader::run, this, fd_, offset_);
+	return true;
+}
+
+size_t blockReader::next(const char *&data_){
+	std::unique_lock<std::mutex> guard(lock);
+
+	// Release the block we were holding so that it may be refilled.
+	int index = 0;
+	if(current >= 0){
+		filled[current] = false;
+		index = 1-current;
+		signal.notify_all();
+	}
+
+	signal.wait(guard, [&](){ return filled[index] || finished || !running; });
+	if(!filled[index]){
+		current = -1;
+		return 0;
+	}
+
+	current = index;
+	data_ = blocks[index].data();
+	return lengths[index];
+}
+
+void blockReader::stop(){
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		if(!running && !worker.joinable()) return;
+		running = false;
+	}
+	signal.notify_all();
+	if(worker.joinable()) worker.join();
+}
+
+void blockReader::run(int fd_, unsigned long long offset_){
+	int index = 0;
+	while(true){
+		{ // Wait for the block to be released by the consumer.
+			std::unique_lock<std::mutex> guard(lock);
+			signal.wait(guard, [&](){ return !filled[index] || !running; });
+			if(!running) return;
+		}
+
+		// Fill the block. The lock is not held while reading.
+		char *dest = blocks[index].data();
+		size_t total = 0;
+		bool eof = false;
+		while(total < blocks[index].size()){
+			ssize_t retval = pread(fd_, dest+total, blocks[index].size()-total, offset_+total);
+			if(retval < 0){
+				if(errno == EINTR) continue;
+				failed = true;
+				eof = true;
+				break;
+			}
+			else if(retval == 0){
+				eof = true;
+				break;
+			}
+			total += retval;
+		}
+		offset_ += total;
+
+		std::lock_guard<std::mutex> guard(lock);
+		if(total > 0){
+			lengths[index] = total;
+			filled[index] = true;
+		}
+		if(eof){
+			finished = true;
+			signal.notify_all();
+			return;
+		}
+		signal.notify_all();
+		index = 1-index;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// class blockWriter
+///////////////////////////////////////////////////////////////////////////////
+
+blockWriter::blockWriter(const size_t &blockSize_/*=16777216*/) : current(0), running(false), failed(false), total(0) {
+	for(int i = 0; i < 2; i++){
+		blocks[i].resize(blockSize_);
+		lengths[i] = 0;
+		full[i] = false;
+	}
+}
+
+blockWriter::~blockWriter(){
+	this->stop();
+}
+
+bool blockWriter::start(const int &fd_){
+	if(running) return false;
+	for(int i = 0; i < 2; i++){
+		lengths[i] = 0;
+		full[i] = false;
+	}
+	current = 0;
+	failed = false;
+	total = 0;
+	running = true;
+	worker = std::thread(&blockWriter::run, this, fd_);
+	return true;
+}
+
+bool blockWriter::write(const char *data_, size_t len_){
+	total += len_;
+	while(len_ > 0){
+		size_t space = blocks[current].size()-lengths[current];
+		size_t nCopy = (len_ < space ? len_ : space);
+		memcpy(blocks[current].data()+lengths[current], data_, nCopy);
+		lengths[current] += nCopy;
+		data_ += nCopy;
+		len_ -= nCopy;
+		if(lengths[current] == blocks[current].size() && !this->swap())
+			return false;
+	}
+	return !failed;
+}
+
+bool blockWriter::flush(){
+	if(lengths[current] > 0 && !this->swap()) return false;
+
+	// Wait for both blocks to be written.
+	std::unique_lock<std::mutex> guard(lock);
+	signal.wait(guard, [&](){ return (!full[0] && !full[1]) || failed; });
+	return !failed;
+}
+
+bool blockWriter::stop(){
+	if(!running) return !failed;
+	bool retval = this->flush();
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		running = false;
+	}
+	signal.notify_all();
+	if(worker.joinable()) worker.join();
+	return retval;
+}
+
+bool blockWriter::swap(){
+	std::unique_lock<std::mutex> guard(lock);
+	full[current] = true;
+	signal.notify_all();
+
+	// Wait for the other block to finish writing before reusing it.
+	current = 1-current;
+	signal.wait(guard, [&](){ return !full[current] || failed; });
+	lengths[current] = 0;
+	return !failed;
+}
+
+void blockWriter::run(int fd_){
+	int index = 0;
+	while(true){
+		{ // Wait for a full block.
+			std::unique_lock<std::mutex> guard(lock);
+			signal.wait(guard, [&](){ return full[index] || !running; });
+			if(!full[index]) return;
+		}
+
+		// Write the block. The lock is not held while writing.
+		const char *src = blocks[index].data();
+		size_t written = 0;
+		while(written < lengths[index]){
+			ssize_t retval = ::write(fd_, src+written, lengths[index]-written);
+			if(retval < 0){
+				if(errno == EINTR) continue;
+				failed = true;
+				break;
+			}
+			written += retval;
+		}
+
+		std::lock_guard<std::mutex> guard(lock);
+		full[index] = false;
+		signal.notify_all();
+		if(failed) return;
+		index = 1-index;
+	}
+}
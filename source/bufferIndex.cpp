@@ -0,0 +1,141 @@
+/** \file bufferIndex.cpp
+  * \brief Persistent sidecar index of buffer offsets in ldf files.
+  *
+  * \author C. R. Thornsberry
+  * \date Oct. 16th, 2026
+  */
+
+#include <iostream>
+#include <fstream>
+#include <string.h>
+
+#include <sys/stat.h>
+
+#include "mappedFile.hpp"
+#include "bufferScan.hpp"
+#include "bufferIndex.hpp"
+
+const char indexMagic[8] = {'L', 'D', 'F', 'I', 'N', 'D', 'X', '2'};
+
+///////////////////////////////////////////////////////////////////////////////
+// class bufferIndex
+///////////////////////////////////////////////////////////////////////////////
+
+bool bufferIndex::load(const std::string &fname_, mappedFile &input_, const size_t &nThreads_/*=1*/, const bool &rebuild_/*=false*/){
+	fileStamp current;
+	if(!bufferIndex::stat(input_, current))
+		return false;
+
+	// Use the existing sidecar if it matches the data file.
+	std::string sidecar = getSidecarName(fname_);
+	if(!rebuild_ && this->read(sidecar) && stamp == current)
+		return true;
+
+	std::cout << " Building buffer index for \"" << fname_ << "\"\n";
+	if(!this->build(input_, nThreads_))
+		return false;
+
+	if(!this->write(sidecar))
+		std::cout << " WARNING: Failed to write buffer index \"" << sidecar << "\"!\n";
+
+	return true;
+}
+
+bool bufferIndex::build(mappedFile &input_, const size_t &nThreads_/*=1*/){
+	entries.clear();
+	if(!input_.isMapped() || !bufferIndex::stat(input_, stamp))
+		return false;
+
+	bufferScan scanner((const unsigned int*)input_.getData(), input_.getSize()/4);
+	std::vector<std::vector<indexEntry> > chunkEntries(nThreads_ > 0 ? nThreads_ : 1);
+	size_t nChunks = scanner.walkParallel(nThreads_, [&](const size_t &chunk_, const bufferInfo &buff_){
+		chunkEntries[chunk_].push_back(indexEntry(buff_.offset*4, buff_.type, (unsigned int)buff_.length));
+	});
+
+	for(size_t i = 0; i < nChunks; i++)
+		entries.insert(entries.end(), chunkEntries[i].begin(), chunkEntries[i].end());
+
+	return true;
+}
+
+bool bufferIndex::read(const std::string &fname_){
+	entries.clear();
+
+	std::ifstream file(fname_.c_str(), std::ios::binary);
+	if(!file.good()) return false;
+
+	char magic[8];
+	unsigned long long count = 0;
+	file.read(magic, 8);
+	file.read((char*)&stamp.size, 8);
+	file.read((char*)&stamp.time, 8);
+	file.read((char*)&stamp.timeNsec, 8);
+	file.read((char*)&stamp.inode, 8);
+	file.read((char*)&count, 8);
+	if(!file.good() || memcmp(magic, indexMagic, 8) != 0)
+		return false;
+
+	// Make sure the sidecar is long enough to hold all of its entries.
+	std::streampos start = file.tellg();
+	file.seekg(0, std::ios::end);
+	if((unsigned long long)(file.tellg()-start) != count*sizeof(indexEntry))
+		return false;
+	file.seekg(start);
+
+	entries.resize(count);
+	file.read((char*)entries.data(), count*sizeof(indexEntry));
+	if(!file.good()){
+		entries.clear();
+		return false;
+	}
+
+	return true;
+}
+
+bool bufferIndex::write(const std::string &fname_) const {
+	std::ofstream file(fname_.c_str(), std::ios::binary);
+	if(!file.good()) return false;
+
+	unsigned long long count = entries.size();
+	file.write(indexMagic, 8);
+	file.write((char*)&stamp.size, 8);
+	file.write((char*)&stamp.time, 8);
+	file.write((char*)&stamp.timeNsec, 8);
+	file.write((char*)&stamp.inode, 8);
+	file.write((char*)&count, 8);
+	file.write((char*)entries.data(), count*sizeof(indexEntry));
+
+	return file.good();
+}
+
+long long bufferIndex::find(const size_t &n_, const unsigned int &type_/*=0*/) const {
+	if(type_ == 0)
+		return (n_ < entries.size() ? (long long)n_ : -1);
+
+	size_t count = 0;
+	for(size_t i = 0; i < entries.size(); i++){
+		if(entries[i].type != type_) continue;
+		if(count++ == n_) return i;
+	}
+
+	return -1;
+}
+
+bool bufferIndex::verify(mappedFile &input_, const size_t &index_) const {
+	if(!input_.isMapped() || index_ >= entries.size()) return false;
+	const indexEntry &entry = entries[index_];
+	if(entry.offset % 4 != 0 || entry.offset+4 > input_.getSize()) return false;
+	const unsigned int word = *(const unsigned int*)(input_.getData()+entry.offset);
+	return (word == entry.type && isBufferHeader(word));
+}
+
+bool bufferIndex::stat(mappedFile &input_, fileStamp &stamp_){
+	struct stat info;
+	if(fstat(input_.getDescriptor(), &info) != 0 || !S_ISREG(info.st_mode))
+		return false;
+	stamp_.size = info.st_size;
+	stamp_.time = (long long)info.st_mtim.tv_sec;
+	stamp_.timeNsec = (long long)info.st_mtim.tv_nsec;
+	stamp_.inode = (unsigned long long)info.st_ino;
+	return true;
+}
@@ -0,0 +1,87 @@
+/** \file bufferScan.cpp
+  * \brief Locates ldf buffers in a span of words, optionally in parallel.
+  *
+  * \author C. R. Thornsberry
+  * \date Oct. 16th, 2026
+  */
+
+#include "bufferScan.hpp"
+
+///////////////////////////////////////////////////////////////////////////////
+// class bufferScan
+///////////////////////////////////////////////////////////////////////////////
+
+bufferScan::bufferScan(const unsigned int *words_, const size_t &nWords_, const bool &swap_/*=false*/) : words(words_), nWords(nWords_), swap(swap_) {
+	for(unsigned int i = 0; i < numBufferTypes; i++)
+		headers.add(swap ? byteSwap(bufferTypes[i]) : bufferTypes[i]);
+}
+
+size_t bufferScan::split(const size_t &nChunks_){
+	syncPoints.clear();
+
+	// Chunks start on buffer boundaries of an undamaged file.
+	std::vector<size_t> candidates;
+	const size_t nBuffers = (nWords+ldfBufferLength-1)/ldfBufferLength;
+	const size_t nChunks = (nChunks_ == 0 ? 1 : (nChunks_ < nBuffers ? nChunks_ : nBuffers));
+	for(size_t i = 0; i < nChunks; i++){
+		size_t start = (nBuffers*i/nChunks)*ldfBufferLength;
+
+		// Chunks which are entirely covered by a previous (overfilled) buffer are dropped.
+		if(!candidates.empty() && start < candidates.back()) continue;
+
+		// Resynchronize on the first buffer header at or after the start of the chunk.
+		size_t sync = headers.find(words+start, words+nWords)-words;
+		if(sync >= nWords) break;
+		if(candidates.empty() || sync > candidates.back())
+			candidates.push_back(sync);
+	}
+
+	if(candidates.size() <= 1){
+		syncPoints = candidates;
+		return syncPoints.size();
+	}
+
+	// A buffer type word found by resynchronizing may be part of the payload of a buffer
+	// which is not aligned to the grid. Walk each chunk from its candidate until reaching
+	// the candidate of the following chunk to find where the chunk really ends.
+	std::vector<size_t> landing(candidates.size()-1);
+	std::vector<std::thread> workers;
+	for(size_t i = 0; i+1 < candidates.size(); i++)
+		workers.push_back(std::thread([this, i, &candidates, &landing](){ landing[i] = this->land(candidates[i], candidates[i+1]); }));
+	for(size_t i = 0; i < workers.size(); i++)
+		workers[i].join();
+
+	// Stitch the chunks in file order. A candidate is kept only if the walk of the previous
+	// chunk lands on it exactly. Otherwise the walk overshot a phantom buffer and the chunk
+	// starts where the walk ended instead.
+	size_t pos = candidates.front();
+	syncPoints.push_back(pos);
+	for(size_t i = 1; i < candidates.size(); i++){
+		if(pos < candidates[i])
+			pos = (pos == candidates[i-1] ? landing[i-1] : this->land(pos, candidates[i]));
+		if(pos >= nWords) break;
+		if(i+1 < candidates.size() && pos >= candidates[i+1]) continue; // The chunk is empty.
+		if(pos > syncPoints.back())
+			syncPoints.push_back(pos);
+	}
+
+	return syncPoints.size();
+}
+
+size_t bufferScan::land(size_t pos_, const size_t &target_) const {
+	while(pos_ < target_)
+		pos_ = this->next(pos_, nWords);
+	return pos_;
+}
+
+size_t bufferScan::next(const size_t &pos_, const size_t &stop_) const {
+	// Check the expected position of the next buffer first.
+	size_t expected = pos_+ldfBufferLength;
+	if(expected < stop_ && isBufferHeader(this->getWord(expected)))
+		return expected;
+	else if(expected == stop_)
+		return stop_;
+
+	// The buffer has the wrong length. Search for the next buffer header.
+	return headers.find(words+pos_+1, words+stop_)-words;
+}
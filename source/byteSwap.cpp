@@ -0,0 +1,103 @@
+/** \file byteSwap.cpp
+  * \brief Vectorized byte order reversal of arrays of data words.
+  *
+  * \author C. R. Thornsberry
+  * \date Oct. 16th, 2026
+  */
+
+#include <string.h>
+
+#include "byteSwap.hpp"
+
+#if defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__))
+#include <immintrin.h>
+#define BYTE_SWAP_X86
+#endif
+
+namespace{
+	template <typename T>
+	void swapScalar(const T *src_, T *dest_, const size_t &nWords_){
+		for(size_t i = 0; i < nWords_; i++)
+			dest_[i] = byteSwap(src_[i]);
+	}
+
+#ifdef BYTE_SWAP_X86
+	/// Byte shuffle control which reverses each word of N bytes within a 16 byte lane.
+	template <size_t N>
+	inline __m128i shuffleControl(){
+		char control[16];
+		for(int i = 0; i < 16; i++)
+			control[i] = (char)((i/N)*N + (N-1-i%N));
+		return _mm_loadu_si128((const __m128i*)control);
+	}
+
+	template <typename T>
+	__attribute__((target("ssse3"))) void swapSSSE3(const T *src_, T *dest_, const size_t &nWords_){
+		const size_t perVector = 16/sizeof(T);
+		const __m128i control = shuffleControl<sizeof(T)>();
+
+		size_t i = 0;
+		for(; i+perVector <= nWords_; i += perVector){
+			__m128i block = _mm_loadu_si128((const __m128i*)(src_+i));
+			_mm_storeu_si128((__m128i*)(dest_+i), _mm_shuffle_epi8(block, control));
+		}
+
+		swapScalar(src_+i, dest_+i, nWords_-i);
+	}
+
+	template <typename T>
+	__attribute__((target("avx2"))) void swapAVX2(const T *src_, T *dest_, const size_t &nWords_){
+		const size_t perVector = 32/sizeof(T);
+		const __m128i lane = shuffleControl<sizeof(T)>();
+		const __m256i control = _mm256_broadcastsi128_si256(lane); // vpshufb shuffles within each 16 byte lane.
+
+		size_t i = 0;
+		for(; i+perVector <= nWords_; i += perVector){
+			__m256i block = _mm256_loadu_si256((const __m256i*)(src_+i));
+			_mm256_storeu_si256((__m256i*)(dest_+i), _mm256_shuffle_epi8(block, control));
+		}
+
+		swapScalar(src_+i, dest_+i, nWords_-i);
+	}
+
+	bool haveAVX2(){
+		static const bool avx2 = __builtin_cpu_supports("avx2");
+		return avx2;
+	}
+
+	bool haveSSSE3(){
+		static const bool ssse3 = __builtin_cpu_supports("ssse3");
+		return ssse3;
+	}
+#endif
+}
+
+template <typename T>
+void byteSwap(const T *src_, T *dest_, const size_t &nWords_){
+	if(sizeof(T) == 1){ // Nothing to swap.
+		if(src_ != dest_) memcpy(dest_, src_, nWords_);
+		return;
+	}
+#ifdef BYTE_SWAP_X86
+	if(haveAVX2()) swapAVX2(src_, dest_, nWords_);
+	else if(haveSSSE3()) swapSSSE3(src_, dest_, nWords_);
+	else swapScalar(src_, dest_, nWords_);
+#else
+	swapScalar(src_, dest_, nWords_);
+#endif
+}
+
+const char *byteSwapInstructionSet(){
+#ifdef BYTE_SWAP_X86
+	if(haveAVX2()) return "avx2";
+	else if(haveSSSE3()) return "ssse3";
+	return "scalar";
+#else
+	return "scalar";
+#endif
+}
+
+template void byteSwap<unsigned char>(const unsigned char*, unsigned char*, const size_t&);
+template void byteSwap<unsigned short>(const unsigned short*, unsigned short*, const size_t&);
+template void byteSwap<unsigned int>(const unsigned int*, unsigned int*, const size_t&);
+template void byteSwap<unsigned long long>(const unsigned long long*, unsigned long long*, const size_t&);
@@ -0,0 +1,114 @@
+/** \file fileCopy.cpp
+  * \brief Kernel assisted copying of byte ranges between files.
+  *
+  * \author C. R. Thornsberry
+  * \date Oct. 16th, 2026
+  */
+
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/stat.h>
+
+#ifdef __linux__
+#include <sys/sendfile.h>
+#include <sys/ioctl.h>
+#include <linux/fs.h>
+#endif
+
+#include "fileCopy.hpp"
+
+namespace{
+	/// Copy with pread() and write() through a user space buffer.
+	bool copyBuffered(const int &fdIn_, unsigned long long &offset_, const int &fdOut_, unsigned long long &length_){
+		std::vector<char> buffer(1048576);
+		while(length_ > 0){
+			size_t request = (length_ < buffer.size() ? length_ : buffer.size());
+			ssize_t nRead = pread(fdIn_, buffer.data(), request, offset_);
+			if(nRead < 0 && errno == EINTR) continue;
+			if(nRead <= 0) return false;
+
+			ssize_t nWritten = 0;
+			while(nWritten < nRead){
+				ssize_t retval = write(fdOut_, buffer.data()+nWritten, nRead-nWritten);
+				if(retval < 0 && errno == EINTR) continue;
+				if(retval <= 0) return false;
+				nWritten += retval;
+			}
+
+			offset_ += nRead;
+			length_ -= nRead;
+		}
+		return true;
+	}
+
+	/// Copy with copy_file_range(), sendfile() or pread() and write(), whichever is supported.
+	bool copyRange(const int &fdIn_, const unsigned long long &offset_, const int &fdOut_, const unsigned long long &length_){
+		unsigned long long offset = offset_;
+		unsigned long long remaining = length_;
+
+#ifdef __linux__
+		// Methods which are not supported for this pair of files are abandoned on their first
+		// call. Anything already copied is kept and the rest is handled by the next method.
+		loff_t offIn = offset;
+		while(remaining > 0){
+			ssize_t retval = copy_file_range(fdIn_, &offIn, fdOut_, NULL, remaining, 0);
+			if(retval < 0 && errno == EINTR) continue;
+			if(retval <= 0) break;
+			remaining -= retval;
+		}
+		offset = offIn;
+
+		off_t offSend = offset;
+		while(remaining > 0){
+			ssize_t retval = sendfile(fdOut_, fdIn_, &offSend, (remaining < 0x40000000 ? remaining : 0x40000000));
+			if(retval < 0 && errno == EINTR) continue;
+			if(retval <= 0) break;
+			remaining -= retval;
+		}
+		offset = offSend;
+#endif
+
+		if(remaining == 0) return true;
+		return copyBuffered(fdIn_, offset, fdOut_, remaining);
+	}
+}
+
+bool copyFileRange(const int &fdIn_, const unsigned long long &offset_, const int &fdOut_, const unsigned long long &length_){
+#ifdef FICLONERANGE
+	// Share the extents of the source file (reflink) if the filesystem allows it. Cloned ranges
+	// must be aligned to filesystem blocks, so the range must start at the same position within
+	// a block in both files. Any unaligned head and tail are copied.
+	struct stat info;
+	off_t position = lseek(fdOut_, 0, SEEK_CUR);
+	if(position >= 0 && fstat(fdOut_, &info) == 0 && info.st_blksize > 0){
+		const unsigned long long blockSize = info.st_blksize;
+		const unsigned long long head = (blockSize-offset_%blockSize)%blockSize;
+		if((unsigned long long)position%blockSize == offset_%blockSize && length_ >= head+blockSize){
+			const unsigned long long body = (length_-head)/blockSize*blockSize;
+			if(!copyRange(fdIn_, offset_, fdOut_, head)) return false;
+
+			struct file_clone_range range;
+			range.src_fd = fdIn_;
+			range.src_offset = offset_+head;
+			range.src_length = body;
+			range.dest_offset = position+head;
+			if(ioctl(fdOut_, FICLONERANGE, &range) == 0 && lseek(fdOut_, position+head+body, SEEK_SET) >= 0)
+				return copyRange(fdIn_, offset_+head+body, fdOut_, length_-head-body);
+
+			return copyRange(fdIn_, offset_+head, fdOut_, length_-head);
+		}
+	}
+#endif
+
+	return copyRange(fdIn_, offset_, fdOut_, length_);
+}
+
+bool isSameFile(const int &fd1_, const int &fd2_){
+	struct stat info1, info2;
+	if(fstat(fd1_, &info1) != 0 || fstat(fd2_, &info2) != 0)
+		return true;
+	return (info1.st_dev == info2.st_dev && info1.st_ino == info2.st_ino);
+}
@@ -0,0 +1,128 @@
+/** \file fileFollower.cpp
+  * \brief Reads data appended to a file which is still being written.
+  *
+  * \author C. R. Thornsberry
+  * \date Oct. 16th, 2026
+  */
+
+#include <string.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <poll.h>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#endif
+
+#include "fileFollower.hpp"
+
+///////////////////////////////////////////////////////////////////////////////
+// class fileFollower
+///////////////////////////////////////////////////////////////////////////////
+
+fileFollower::fileFollower(const size_t &capacity_/*=2097152*/) : fd(-1), notifyFd(-1), head(0), tail(0) {
+	size_t capacity = 4096;
+	while(capacity < capacity_)
+		capacity <<= 1;
+	ring.resize(capacity);
+	mask = capacity-1;
+}
+
+fileFollower::~fileFollower(){
+	this->close();
+}
+
+bool fileFollower::open(const std::string &fname_, const unsigned long long &offset_){
+	this->close();
+
+	fd = ::open(fname_.c_str(), O_RDONLY);
+	if(fd < 0) return false;
+
+	head = offset_;
+	tail = offset_;
+
+#ifdef __linux__
+	// Fall back to polling if inotify is unavailable (e.g. on some network filesystems).
+	notifyFd = inotify_init1(IN_NONBLOCK);
+	if(notifyFd >= 0 && inotify_add_watch(notifyFd, fname_.c_str(), IN_MODIFY | IN_CLOSE_WRITE) < 0){
+		::close(notifyFd);
+		notifyFd = -1;
+	}
+#endif
+
+	return true;
+}
+
+void fileFollower::close(){
+	if(notifyFd >= 0) ::close(notifyFd);
+	if(fd >= 0) ::close(fd);
+	notifyFd = -1;
+	fd = -1;
+}
+
+bool fileFollower::wait(const int &timeout_){
+	if(notifyFd < 0){ // Polling.
+		usleep(timeout_*1000);
+		return true;
+	}
+
+	struct pollfd pfd;
+	pfd.fd = notifyFd;
+	pfd.events = POLLIN;
+	if(poll(&pfd, 1, timeout_) <= 0)
+		return false;
+
+	// Drain all pending events. We only care that something happened.
+	char events[4096];
+	while(::read(notifyFd, events, sizeof(events)) > 0){ }
+
+	return true;
+}
+
+size_t fileFollower::update(){
+	size_t total = 0;
+	while(!this->full()){
+		// Read into the contiguous free space following the head of the ring.
+		size_t start = head & mask;
+		size_t space = ring.size()-this->available();
+		if(space > ring.size()-start) space = ring.size()-start;
+
+		ssize_t retval = pread(fd, ring.data()+start, space, head);
+		if(retval < 0){
+			if(errno == EINTR) continue;
+			break;
+		}
+		else if(retval == 0) break; // No new data.
+
+		head += retval;
+		total += retval;
+	}
+	return total;
+}
+
+unsigned int fileFollower::getWord(const size_t &index_) const {
+	unsigned int word;
+	size_t start = (tail+index_*4) & mask;
+	if(start+4 <= ring.size()){ memcpy((char*)&word, ring.data()+start, 4); }
+	else{ // The word wraps around the end of the ring.
+		size_t nFirst = ring.size()-start;
+		memcpy((char*)&word, ring.data()+start, nFirst);
+		memcpy((char*)&word+nFirst, ring.data(), 4-nFirst);
+	}
+	return word;
+}
+
+size_t fileFollower::peek(char *dest_, const size_t &len_) const {
+	size_t len = (len_ < this->available() ? len_ : this->available());
+	size_t start = tail & mask;
+	size_t nFirst = (len < ring.size()-start ? len : ring.size()-start);
+	memcpy(dest_, ring.data()+start, nFirst);
+	memcpy(dest_+nFirst, ring.data(), len-nFirst);
+	return len;
+}
+
+void fileFollower::consume(const size_t &len_){
+	tail += (len_ < this->available() ? len_ : this->available());
+}
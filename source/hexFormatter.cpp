@@ -0,0 +1,89 @@
+/** \file hexFormatter.cpp
+  * \brief Table driven hexadecimal and ascii formatting of data words.
+  *
+  * \author C. R. Thornsberry
+  * \date Oct. 16th, 2026
+  */
+
+#include <string.h>
+
+#include "hexFormatter.hpp"
+
+#define HEX_PAIRS_4(h) h"0" h"1" h"2" h"3"
+#define HEX_PAIRS_16(h) HEX_PAIRS_4(h) h"4" h"5" h"6" h"7" h"8" h"9" h"A" h"B" h"C" h"D" h"E" h"F"
+
+const char hexDigitPairs[] = {
+	HEX_PAIRS_16("0") HEX_PAIRS_16("1") HEX_PAIRS_16("2") HEX_PAIRS_16("3")
+	HEX_PAIRS_16("4") HEX_PAIRS_16("5") HEX_PAIRS_16("6") HEX_PAIRS_16("7")
+	HEX_PAIRS_16("8") HEX_PAIRS_16("9") HEX_PAIRS_16("A") HEX_PAIRS_16("B")
+	HEX_PAIRS_16("C") HEX_PAIRS_16("D") HEX_PAIRS_16("E") HEX_PAIRS_16("F")
+};
+
+#undef HEX_PAIRS_16
+#undef HEX_PAIRS_4
+
+const char asciiTable[256] = {
+	' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', // 0x00
+	' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', // 0x10
+	' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', // 0x20
+	'0', '1', '2', '3', '4', '5', '6', '7', '8', '9', ' ', ' ', ' ', ' ', ' ', ' ', // 0x30
+	' ', 'A', 'B', 'C', 'D', 'E', 'F', 'G', 'H', 'I', 'J', 'K', 'L', 'M', 'N', 'O', // 0x40
+	'P', 'Q', 'R', 'S', 'T', 'U', 'V', 'W', 'X', 'Y', 'Z', ' ', ' ', ' ', ' ', ' ', // 0x50
+	' ', 'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h', 'i', 'j', 'k', 'l', 'm', 'n', 'o', // 0x60
+	'p', 'q', 'r', 's', 't', 'u', 'v', 'w', 'x', 'y', 'z', ' ', ' ', ' ', ' ', ' ', // 0x70
+	' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', // 0x80
+	' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', // 0x90
+	' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', // 0xA0
+	' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', // 0xB0
+	' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', // 0xC0
+	' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', // 0xD0
+	' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', // 0xE0
+	' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' ', ' '  // 0xF0
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// class hexFormatter
+///////////////////////////////////////////////////////////////////////////////
+
+hexFormatter::hexFormatter(FILE *file_/*=stdout*/, const size_t &size_/*=4194304*/) : file(file_), size(size_), index(0) {
+	if(size < 64) size = 64; // Must hold at least one formatted word.
+	buffer = new char[size];
+}
+
+hexFormatter::~hexFormatter(){
+	this->flush();
+	delete[] buffer;
+}
+
+void hexFormatter::put(const char *str_, const size_t &len_){
+	if(len_ > size){ // Too large to buffer. Write it out directly.
+		this->flush();
+		fwrite(str_, 1, len_, file);
+		return;
+	}
+	this->reserve(len_);
+	memcpy(buffer+index, str_, len_);
+	index += len_;
+}
+
+void hexFormatter::putDecimal(unsigned long long val_, const size_t &width_/*=0*/, const char &fill_/*='0'*/){
+	char digits[20];
+	size_t nDigits = 0;
+	do{
+		digits[nDigits++] = '0' + (val_ % 10);
+		val_ /= 10;
+	} while(val_ > 0);
+
+	size_t nPad = (width_ > nDigits ? width_-nDigits : 0);
+	this->reserve(nPad+nDigits);
+	for(size_t i = 0; i < nPad; i++)
+		buffer[index++] = fill_;
+	while(nDigits > 0)
+		buffer[index++] = digits[--nDigits];
+}
+
+void hexFormatter::flush(){
+	if(index == 0) return;
+	fwrite(buffer, 1, index, file);
+	index = 0;
+}
@@ -0,0 +1,469 @@
+/** \file hexPager.cpp
+  * \brief Interactive full screen viewer for memory mapped data files.
+  *
+  * \author C. R. Thornsberry
+  * \date Oct. 16th, 2026
+  */
+
+#include <iostream>
+#include <sstream>
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <termios.h>
+#include <sys/ioctl.h>
+
+#include "hexPager.hpp"
+#include "mappedFile.hpp"
+#include "wordSearch.hpp"
+
+/// Codes returned by readKey() for special keys (KEY_REDRAW is returned after the viewer was suspended).
+enum PAGER_KEYS {KEY_UP=1000, KEY_DOWN, KEY_PAGE_UP, KEY_PAGE_DOWN, KEY_HOME, KEY_END, KEY_REDRAW};
+
+/// Help text displayed on the status line.
+const char *pagerHelp = "j/k:line  space/b:page  g/G:start/end  o:offset  ]/[:next/prev buffer  t:type  /:search  n:next match  q:quit";
+
+/* The terminal state is kept outside of the viewer so that it may be restored by
+ * the signal handlers and at exit, using only async signal safe functions. Signals
+ * are not generated by the keyboard in raw mode (^C and ^Z are read as keys).
+ */
+namespace{
+	struct termios originalTerm; ///< Terminal settings prior to entering raw mode.
+	struct termios rawTerm; ///< Terminal settings of the viewer.
+	volatile sig_atomic_t terminalRaw = 0; ///< Set while the terminal is in raw mode and on the alternate screen.
+	bool exitHandlerSet = false; ///< Set once the terminal is restored at exit.
+
+	const char enterScreen[] = "\033[?1049h\033[?25l"; ///< Switch to the alternate screen and hide the cursor.
+	const char leaveScreen[] = "\033[?25h\033[?1049l"; ///< Show the cursor and return to the normal screen.
+
+	/// Signals which terminate the viewer.
+	const int terminateSignals[] = {SIGINT, SIGTERM, SIGHUP, SIGQUIT};
+	const size_t numTerminateSignals = sizeof(terminateSignals)/sizeof(terminateSignals[0]);
+
+	void writeString(const char *str_, const size_t &length_){
+		ssize_t retval = write(STDOUT_FILENO, str_, length_);
+		(void)retval;
+	}
+
+	/// Leave the alternate screen and restore the original terminal settings.
+	void restoreTerminal(){
+		if(!terminalRaw) return;
+		terminalRaw = 0;
+		writeString(leaveScreen, sizeof(leaveScreen)-1);
+		tcsetattr(STDIN_FILENO, TCSAFLUSH, &originalTerm);
+	}
+
+	/// Restore the terminal and terminate using the default action of the signal.
+	void terminateHandler(int signum_){
+		restoreTerminal();
+		signal(signum_, SIG_DFL);
+		raise(signum_);
+	}
+
+	/// Restore the terminal before stopping and return to the viewer once continued.
+	void suspendHandler(int){
+		const int savedErrno = errno;
+		const bool wasRaw = terminalRaw;
+		restoreTerminal();
+
+		// Stop using the default action, which is blocked while this handler runs.
+		sigset_t mask;
+		sigemptyset(&mask);
+		sigaddset(&mask, SIGTSTP);
+		signal(SIGTSTP, SIG_DFL);
+		sigprocmask(SIG_UNBLOCK, &mask, NULL);
+		raise(SIGTSTP);
+		sigprocmask(SIG_BLOCK, &mask, NULL);
+
+		struct sigaction action;
+		action.sa_handler = suspendHandler;
+		sigemptyset(&action.sa_mask);
+		action.sa_flags = 0; // Interrupt the pending read so that the screen is redrawn.
+		sigaction(SIGTSTP, &action, NULL);
+
+		if(wasRaw){
+			tcsetattr(STDIN_FILENO, TCSAFLUSH, &rawTerm);
+			writeString(enterScreen, sizeof(enterScreen)-1);
+			terminalRaw = 1;
+		}
+		errno = savedErrno;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// class hexPager
+///////////////////////////////////////////////////////////////////////////////
+
+hexPager::hexPager(mappedFile &input_, const bool &convert_/*=false*/) :
+	words((const unsigned int*)input_.getData()), nWords(input_.getSize()/4), top(0), rows(1), columns(1), convert(convert_), bufferType(0),
+	output(stdout, 65536), scanner((const unsigned int*)input_.getData(), input_.getSize()/4) {
+	// Only the visible part of the file is touched, so there is no point in reading ahead.
+	input_.setRandomAccess();
+}
+
+hexPager::~hexPager(){
+	this->leaveRawMode();
+}
+
+bool hexPager::run(const unsigned long long &start_){
+	if(!isatty(STDIN_FILENO) || !isatty(STDOUT_FILENO)){
+		std::cout << " ERROR: The interactive viewer requires a terminal!\n";
+		return false;
+	}
+	if(!this->enterRawMode()){
+		std::cout << " ERROR: Failed to configure the terminal!\n";
+		return false;
+	}
+
+	top = start_;
+	message = pagerHelp;
+
+	bool running = true;
+	while(running){
+		this->updateLayout();
+		this->clampTop();
+		this->render();
+		message.clear();
+
+		int key = this->readKey();
+		switch(key){
+			case 'q':
+			case 'Q':
+			case 3: // ^C
+				running = false;
+				break;
+			case 26: // ^Z
+				raise(SIGTSTP);
+				break;
+			case 'j':
+			case '\r':
+			case '\n':
+			case KEY_DOWN:
+				top += columns;
+				break;
+			case 'k':
+			case KEY_UP:
+				top = (top > columns ? top-columns : 0);
+				break;
+			case ' ':
+			case 'f':
+			case KEY_PAGE_DOWN:
+				top += rows*columns;
+				break;
+			case 'b':
+			case KEY_PAGE_UP:
+				top = (top > rows*columns ? top-rows*columns : 0);
+				break;
+			case 'g':
+			case KEY_HOME:
+				top = 0;
+				break;
+			case 'G':
+			case KEY_END:
+				top = nWords;
+				break;
+			case 'o':
+			case ':':{
+				std::string arg = this->prompt("Word offset: ");
+				if(!arg.empty()) top = strtoull(arg.c_str(), NULL, 0);
+				break;
+			}
+			case ']':
+				if(!this->nextBuffer()) message = "No more buffers";
+				break;
+			case '[':
+				if(!this->previousBuffer()) message = "No previous buffers";
+				break;
+			case 't':{
+				std::string arg = this->prompt("Buffer type (name or word, empty for any): ");
+				bufferType = 0;
+				for(unsigned int i = 0; i < numBufferTypes; i++){
+					std::string name(bufferNames[i]);
+					if(name[name.size()-1] == ' ') name.erase(name.size()-1);
+					if(arg == name){
+						bufferType = bufferTypes[i];
+						break;
+					}
+				}
+				if(bufferType == 0 && !arg.empty()) bufferType = strtoul(arg.c_str(), NULL, 0);
+				if(bufferType != 0 && !this->nextBuffer()) message = "No more buffers of this type";
+				break;
+			}
+			case '/':{
+				std::stringstream stream(this->prompt("Search for <int[,int,...]>: "));
+				std::string value;
+				searchValues.clear();
+				while(std::getline(stream, value, ',') && searchValues.size() < wordSearch<unsigned int>::maxNeedles)
+					searchValues.push_back(strtoul(value.c_str(), NULL, 0));
+				if(!searchValues.empty() && !this->searchForward()) message = "Pattern not found";
+				break;
+			}
+			case 'n':
+				if(searchValues.empty()) message = "No previous search";
+				else if(!this->searchForward()) message = "Pattern not found";
+				break;
+			case 'h':
+			case '?':
+				message = pagerHelp;
+				break;
+			default:
+				break;
+		}
+	}
+
+	this->leaveRawMode();
+
+	return true;
+}
+
+bool hexPager::enterRawMode(){
+	if(terminalRaw) return true;
+	if(tcgetattr(STDIN_FILENO, &originalTerm) != 0) return false;
+
+	rawTerm = originalTerm;
+	rawTerm.c_lflag &= ~(ICANON | ECHO | ISIG);
+	rawTerm.c_iflag &= ~(IXON | ICRNL);
+	rawTerm.c_cc[VMIN] = 1;
+	rawTerm.c_cc[VTIME] = 0;
+
+	// Make sure that the terminal is restored however the program ends.
+	if(!exitHandlerSet){
+		atexit(restoreTerminal);
+		exitHandlerSet = true;
+	}
+	struct sigaction action;
+	sigemptyset(&action.sa_mask);
+	action.sa_flags = 0;
+	action.sa_handler = terminateHandler;
+	for(size_t i = 0; i < numTerminateSignals; i++)
+		sigaction(terminateSignals[i], &action, NULL);
+	action.sa_handler = suspendHandler;
+	sigaction(SIGTSTP, &action, NULL);
+
+	terminalRaw = 1;
+	if(tcsetattr(STDIN_FILENO, TCSAFLUSH, &rawTerm) != 0){
+		terminalRaw = 0;
+		this->leaveRawMode();
+		return false;
+	}
+
+	// Switch to the alternate screen so that the user's terminal is restored on exit.
+	writeString(enterScreen, sizeof(enterScreen)-1);
+
+	return true;
+}
+
+void hexPager::leaveRawMode(){
+	output.flush();
+	fflush(stdout);
+	restoreTerminal();
+	for(size_t i = 0; i < numTerminateSignals; i++)
+		signal(terminateSignals[i], SIG_DFL);
+	signal(SIGTSTP, SIG_DFL);
+}
+
+void hexPager::updateLayout(){
+	size_t height = 24;
+	size_t width = 80;
+
+	struct winsize size;
+	if(ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) == 0 && size.ws_row > 0 && size.ws_col > 0){
+		height = size.ws_row;
+		width = size.ws_col;
+	}
+
+	// One line is reserved for the status line. Each row begins with a 12 digit word offset.
+	rows = (height > 2 ? height-1 : 1);
+	size_t wordWidth = (convert ? 16 : 10);
+	columns = (width > 14+wordWidth ? (width-14)/wordWidth : 1);
+	if(columns > 16) columns = 16;
+}
+
+void hexPager::clampTop(){
+	if(nWords == 0){
+		top = 0;
+		return;
+	}
+
+	// Do not scroll past the last full screen of the file.
+	size_t screen = rows*columns;
+	size_t last = (nWords > screen ? nWords-screen : 0);
+	if(top > last) top = last;
+}
+
+void hexPager::render(){
+	output.put("\033[H", 3);
+	for(size_t row = 0; row < rows; row++){
+		size_t pos = top+row*columns;
+		if(pos < nWords){
+			output.putDecimal(pos, 12, ' ');
+			output.put("  ", 2);
+			size_t stop = (pos+columns < nWords ? pos+columns : nWords);
+			for(size_t i = pos; i < stop; i++){
+				// Highlight buffer headers.
+				if(isBufferHeader(words[i])){
+					output.put("\033[7m", 4);
+					output.putHex(words[i]);
+					output.put("\033[0m", 4);
+				}
+				else output.putHex(words[i]);
+				if(convert){
+					output.put(' ');
+					output.putAscii(words[i]);
+				}
+				output.put("  ", 2);
+			}
+		}
+		else output.put('~');
+		output.put("\033[K\r\n", 5);
+	}
+
+	// Status line.
+	output.put("\033[7m", 4);
+	output.put(" Word ");
+	output.putDecimal(top);
+	output.put('/');
+	output.putDecimal(nWords);
+	size_t start = this->findBufferStart(top);
+	if(start < nWords){
+		int typeIndex = getBufferTypeIndex(words[start]);
+		output.put("  ");
+		output.put(bufferNames[typeIndex], 4);
+		output.put(" +");
+		output.putDecimal(top-start);
+	}
+	if(bufferType != 0){
+		int typeIndex = getBufferTypeIndex(bufferType);
+		output.put("  [type ");
+		if(typeIndex >= 0) output.put(bufferNames[typeIndex], 4);
+		else output.putHex(bufferType);
+		output.put(']');
+	}
+	if(!message.empty()){
+		output.put("  ");
+		output.put(message);
+	}
+	output.put("\033[K\033[0m", 7);
+	output.flush();
+	fflush(stdout);
+}
+
+int hexPager::readKey(){
+	char c;
+	while(true){
+		ssize_t retval = read(STDIN_FILENO, &c, 1);
+		if(retval == 1) break;
+		if(retval < 0 && errno == EINTR) return KEY_REDRAW; // Continued after being suspended.
+		return 'q'; // End of input.
+	}
+	if(c != '\033') return (unsigned char)c;
+
+	// Decode escape sequences of the arrow and paging keys. A lone escape is not followed by anything.
+	struct pollfd pfd;
+	pfd.fd = STDIN_FILENO;
+	pfd.events = POLLIN;
+	if(poll(&pfd, 1, 50) <= 0) return '\033';
+
+	char seq[3];
+	if(read(STDIN_FILENO, &seq[0], 1) != 1 || read(STDIN_FILENO, &seq[1], 1) != 1) return '\033';
+	if(seq[0] != '[' && seq[0] != 'O') return '\033';
+	switch(seq[1]){
+		case 'A': return KEY_UP;
+		case 'B': return KEY_DOWN;
+		case 'H': return KEY_HOME;
+		case 'F': return KEY_END;
+		default: break;
+	}
+	if(seq[1] >= '0' && seq[1] <= '9' && read(STDIN_FILENO, &seq[2], 1) == 1 && seq[2] == '~'){
+		switch(seq[1]){
+			case '1': return KEY_HOME;
+			case '4': return KEY_END;
+			case '5': return KEY_PAGE_UP;
+			case '6': return KEY_PAGE_DOWN;
+			default: break;
+		}
+	}
+	return '\033';
+}
+
+std::string hexPager::prompt(const std::string &text_){
+	std::string input;
+	output.put("\033[?25h", 6);
+	while(true){
+		output.put('\r');
+		output.put("\033[K", 3);
+		output.put(text_);
+		output.put(input);
+		output.flush();
+		fflush(stdout);
+
+		int key = this->readKey();
+		if(key == '\r' || key == '\n') break;
+		else if(key == '\033'){ // Cancel.
+			input.clear();
+			break;
+		}
+		else if(key == 127 || key == '\b'){
+			if(!input.empty()) input.erase(input.size()-1);
+		}
+		else if(key >= 32 && key < 127) input += (char)key;
+	}
+	output.put("\033[?25l", 6);
+	return input;
+}
+
+size_t hexPager::findBufferStart(const size_t &pos_) const {
+	if(pos_ >= nWords) return nWords;
+	size_t stop = (pos_ > ldfBufferLength ? pos_-ldfBufferLength : 0);
+	for(size_t i = pos_+1; i > stop; i--){
+		if(isBufferHeader(words[i-1])) return i-1;
+	}
+	return nWords;
+}
+
+bool hexPager::nextBuffer(){
+	size_t pos = this->findBufferStart(top);
+	if(pos == nWords) pos = top;
+
+	// Hop from buffer to buffer. Only one word is touched per buffer of an undamaged file.
+	do{
+		pos = scanner.next(pos, nWords);
+	} while(pos < nWords && bufferType != 0 && words[pos] != bufferType);
+
+	if(pos >= nWords) return false;
+	top = pos;
+	return true;
+}
+
+bool hexPager::previousBuffer(){
+	size_t pos = top;
+	while(pos > 0){
+		// Check the expected position of the previous buffer before searching word by word.
+		if(pos >= ldfBufferLength && isBufferHeader(words[pos]) && isBufferHeader(words[pos-ldfBufferLength])){
+			pos -= ldfBufferLength;
+		}
+		else{
+			pos--;
+			while(pos > 0 && !isBufferHeader(words[pos])) pos--;
+			if(!isBufferHeader(words[pos])) return false;
+		}
+
+		if(bufferType == 0 || words[pos] == bufferType){
+			top = pos;
+			return true;
+		}
+	}
+	return false;
+}
+
+bool hexPager::searchForward(){
+	if(top+1 >= nWords) return false;
+	wordSearch<unsigned int> searcher(searchValues);
+	const unsigned int *ptr = searcher.find(words+top+1, words+nWords);
+	if(ptr == words+nWords) return false;
+	top = ptr-words;
+	return true;
+}
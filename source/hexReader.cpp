@@ -7,29 +7,52 @@
 
 #include <string>
 #include <iostream>
-#include <fstream>
 #include <sstream>
-#include <bitset>
+#include <vector>
+#include <iomanip>
+#include <cmath>
+#include <algorithm>
+#include <unordered_map>
+#include <map>
 #include <stdlib.h>
 #include <string.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <unistd.h>
 
 #include "optionHandler.hpp"
 
-#define HEAD 1145128264 // Run begin buffer
-#define DATA 1096040772 // Physics data buffer
-#define SCAL 1279345491 // Scaler type buffer
-#define DEAD 1145128260 // Deadtime buffer
-#define DIR 542263620   // "DIR "
-#define PAC 541278544   // "PAC "
-#define ENDFILE 541478725 // End of file buffer
-#define ENDBUFF -1 // End of buffer marker
+#include "mappedFile.hpp"
+#include "hexFormatter.hpp"
+#include "wordSearch.hpp"
+#include "byteSwap.hpp"
+#include "bufferScan.hpp"
+#include "bufferIndex.hpp"
+#include "fileFollower.hpp"
+#include "spillReader.hpp"
+#include "hexPager.hpp"
+#include "fileCopy.hpp"
 
 unsigned int buffer_select = 0;
-unsigned int search_int = 0;
+std::vector<unsigned long long> search_list;
+std::vector<std::pair<unsigned long long, unsigned long long> > search_pattern;
+unsigned int context_before = 0;
+unsigned int context_after = 4;
 bool show_raw = false;
 bool convert = false;
 bool show_zero = true;
 bool do_search = false;
+bool count_only = false;
+bool swap_bytes = false;
+unsigned int num_threads = 1;
+unsigned long long buffer_base = 0;
+unsigned long long word_limit = 0;
+
+volatile sig_atomic_t follow_running = 1;
+size_t max_anomalies = 100;
+double outlier_sigma = 4.0;
+
+hexFormatter raw_output;
 
 /* Extract a string from a character array. */
 std::string csubstr(char *str_, unsigned int start_index_=0){
@@ -42,81 +65,53 @@ std::string csubstr(char *str_, unsigned int start_index_=0){
 	return output;
 }
 
-bool is_alpha_numeric(const char &input_){
-	if((input_ >= 0x30 && input_ <= 0x39) || (input_ >= 0x41 && input_ <= 0x5a) || (input_ >= 0x61 && input_ <= 0x7a)) return true;
-	return false;
-}
-
 template <typename T>
 std::string convert_to_ascii(T input_){
-	char *output = new char[sizeof(T)+1];
-
-	memcpy(output, (char*)&input_, sizeof(T));
+	char output[sizeof(T)];
+	const unsigned char *bytes = (const unsigned char*)&input_;
 	for(size_t i = 0; i < sizeof(T); i++){
-		if(!is_alpha_numeric(output[i])) output[i] = 0x20;	
+		output[i] = asciiTable[bytes[i]];
 	}
-	output[sizeof(T)] = '\0';
-	
-	return std::string(output);
+	return std::string(output, sizeof(T));
 }
 
 template <typename T>
 std::string convert_to_hex(T input_){
-	std::bitset<sizeof(T)*8> set(input_);  
-	std::stringstream stream;
-	stream << std::hex << std::uppercase << set.to_ulong();
-	std::string output = stream.str();
-	if(output.size() < sizeof(T)*2){
-		std::string temp = "0x";
-		for(unsigned int i = output.size(); i < sizeof(T)*2; i++){
-			temp += '0';
-		}
-		return temp + output;
+	char output[2+2*sizeof(T)] = {'0', 'x'};
+	for(size_t i = 0; i < sizeof(T); i++){
+		const char *pair = hexDigitPairs+2*((input_ >> (8*(sizeof(T)-1-i))) & 0xFF);
+		output[2+2*i] = pair[0];
+		output[3+2*i] = pair[1];
 	}
+	return std::string(output, 2+2*sizeof(T));
+}
 
-	return "0x" + output;
+/** Return a pointer to the words of a buffer in native byte order. If swap_bytes is set,
+  * the buffer is swapped into scratch_ (which must outlive any use of the pointer).
+  */
+const unsigned int *getBufferWords(const unsigned int *words_, const bufferInfo &buff_, std::vector<unsigned int> &scratch_){
+	if(!swap_bytes) return words_+buff_.offset;
+	scratch_.resize(buff_.length);
+	byteSwap(words_+buff_.offset, scratch_.data(), buff_.length);
+	return scratch_.data();
 }
 
-template <typename T>
-void go(std::ifstream *input_, unsigned int &buff_count, unsigned int &good_buff_count, unsigned int &total_count){
+/// Scanner state which must persist between consecutive spans of the input file.
+struct scanState{
 	bool good_buffer;
-	int show_next = 0;
-	unsigned int count = 0;
-	unsigned int word_count = 0;
+	unsigned int count;
+	unsigned int word_count;
+	
+	scanState() : good_buffer(buffer_select == 0), count(0), word_count(0) { }
+};
+
+template <typename T>
+void go(const T *begin_, const T *end_, scanState &state, unsigned long long &buff_count, unsigned long long &good_buff_count, unsigned long long &total_count){
 	unsigned int words_per_line = 10;
 	if(convert) words_per_line = 5;
 
-	T word;
-
-	if(buffer_select != 0){ good_buffer = false; }
-	else{ good_buffer = true; }
-
-	while(true){
-		input_->read((char*)&word, sizeof(T));
-		if(input_->eof()){ 
-			if(buff_count > 1){
-				std::cout << " Buffer Size: " << word_count << " words\n";
-				std::cout << "============================================================================================================================\n";
-			}
-			break; 
-		}
-
-		if(do_search){
-			if(show_next > 0){
-				std::cout << convert_to_hex(word) << "  ";
-				if(convert){ std::cout << convert_to_ascii(word) << "  "; }
-				show_next = show_next - 1;
-				if(show_next <= 0){ std::cout << std::endl; }
-			}		
-			else if(word == search_int){
-				std::cout << convert_to_hex(word) << "  ";
-				if(convert){ std::cout << convert_to_ascii(word) << "  "; }
-				show_next = 4;
-			}
-			total_count++;
-			word_count++;
-			continue;
-		}
+	for(const T *ptr = begin_; ptr != end_; ++ptr){
+		const T word = *ptr;
 
 		// Check for end of buffer
 		/*if(word == ENDBUFF || (!show_zero && word == 0)){
@@ -125,7 +120,7 @@ void go(std::ifstream *input_, unsigned int &buff_count, unsigned int &good_buff
 		}*/
 		if((!show_zero && word == 0)){
 			total_count++;
-			word_count++;
+			state.word_count++;
 			continue;
 		}
 				
@@ -133,19 +128,20 @@ void go(std::ifstream *input_, unsigned int &buff_count, unsigned int &good_buff
 		if(word == HEAD || word == DATA || word == SCAL || word == DEAD || word == DIR || word == PAC || word == ENDFILE){ // new buffer
 			buff_count++;
 			if(buffer_select != 0){
-				if(word == buffer_select){ good_buffer = true; }
-				else{ good_buffer = false; }
+				if(word == buffer_select){ state.good_buffer = true; }
+				else{ state.good_buffer = false; }
 			}
 			
-			if(good_buffer){
+			if(state.good_buffer){
+				raw_output.flush();
 				good_buff_count++;
 				if(buff_count > 1){
 					if(show_raw){ std::cout << "\n"; }
-					std::cout << "\n Buffer Size: " << word_count << " words\n";
+					std::cout << "\n Buffer Size: " << state.word_count << " words\n";
 					std::cout << "============================================================================================================================\n";
 				}
 				std::cout << "\n============================================================================================================================\n";
-				std::cout << " Buffer Number: " << buff_count << std::endl;
+				std::cout << " Buffer Number: " << buffer_base+buff_count << std::endl;
 				std::cout << " Buffer Type: " << convert_to_hex(word);
 				if(word == HEAD){ std::cout << " \"HEAD\"\n"; }
 				else if(word == DATA){ std::cout << " \"DATA\"\n"; }
@@ -155,36 +151,1329 @@ void go(std::ifstream *input_, unsigned int &buff_count, unsigned int &good_buff
 				else if(word == DIR){ std::cout << " \"DIR\"\n"; }
 				else if(word == PAC){ std::cout << " \"PAC\"\n"; }
 				std::cout << " Total Count: " << total_count << " words\n";
-				count = 0;
+				state.count = 0;
 			}
-			word_count = 0; // New buffer. Reset the buffer word count
+			state.word_count = 0; // New buffer. Reset the buffer word count
 		}
 		
-		if(!good_buffer){ // We don't care about this buffer
+		if(!state.good_buffer){ // We don't care about this buffer
 			total_count++;
-			word_count++;
+			state.word_count++;
 			continue; 
 		} 
 
 		total_count++;
-		word_count++;
+		state.word_count++;
 		if(show_raw){
-			if(count == 0){ std::cout << "\n0000  "; }
-			else if(count % words_per_line == 0){ 
-				std::stringstream stream; stream << count;
-				std::string temp_string = stream.str();
-				std::string padding = "";
-				if(temp_string.size() < 4){
-					for(unsigned int i = 0; i < (4 - temp_string.size()); i++){ 
-						padding += "0";
-					}
+			if(state.count % words_per_line == 0){ 
+				raw_output.put('\n');
+				raw_output.putDecimal(state.count, 4);
+				raw_output.put("  ", 2); 
+			}
+			raw_output.putHex(word);
+			raw_output.put("  ", 2);
+			state.count++;
+			if(convert){
+				raw_output.putAscii(word);
+				raw_output.put("  ", 2);
+			}
+		}
+	}
+}
+
+/** Walk the input file as a span of words of type T, starting at byte offset foffset_.
+  * Mapped files are passed to func_ as a single span covering the memory map. Streamed
+  * inputs are read in large blocks and passed to func_ one block at a time. The second
+  * argument to func_ is the word offset of the start of the span within the file.
+  * If swap_ is set, the byte order of every word is reversed before it is passed to
+  * func_. Mapped files are then swapped into a small scratch block, one block at a time.
+  * At most word_limit words are walked, if it is non-zero. Only the pages of the memory
+  * map which lie within the limit are ever faulted in.
+  */
+template <typename T, typename F>
+bool forEachSpan(mappedFile &input_, const unsigned long long &foffset_, F func_, const bool &swap_=false){
+	if(input_.isMapped()){
+		if(foffset_ < input_.getSize()){
+			const T *begin = (const T*)(input_.getData()+foffset_);
+			const T *end = begin + (input_.getSize()-foffset_)/sizeof(T);
+			if(word_limit > 0 && word_limit < (unsigned long long)(end-begin)) end = begin+word_limit;
+			if(!swap_){
+				func_(begin, end, foffset_/sizeof(T));
+				return true;
+			}
+
+			// Small enough to stay in cache between the swap and the consumer.
+			const size_t scratchSize = 65536;
+			std::vector<T> scratch(scratchSize);
+			unsigned long long offset = foffset_/sizeof(T);
+			for(const T *ptr = begin; ptr != end; ){
+				size_t nWords = (size_t)(end-ptr) < scratchSize ? end-ptr : scratchSize;
+				byteSwap(ptr, scratch.data(), nWords);
+				func_(scratch.data(), scratch.data()+nWords, offset);
+				ptr += nWords;
+				offset += nWords;
+			}
+		}
+		return true;
+	}
+
+	if(foffset_ > 0 && !input_.skip(foffset_)){
+		std::cout << " ERROR: Failed to skip to the requested start word!\n";
+		return false;
+	}
+
+	// Stream the file in large blocks. Any partial word left over at
+	// the end of a block is carried over to the start of the next one.
+	const size_t blockSize = 1048576;
+	std::vector<T> block(blockSize);
+	unsigned long long offset = foffset_/sizeof(T);
+	unsigned long long remaining = (word_limit > 0 ? word_limit : (unsigned long long)(-1));
+	size_t carry = 0;
+	while(remaining > 0){
+		size_t request = (remaining < blockSize ? remaining : blockSize)*sizeof(T)-carry;
+		size_t nBytes = input_.read((char*)block.data()+carry, request) + carry;
+		size_t nWords = nBytes/sizeof(T);
+		if(nWords == 0) break;
+		remaining -= nWords;
+		if(swap_) byteSwap(block.data(), block.data(), nWords);
+		func_(block.data(), block.data()+nWords, offset);
+		offset += nWords;
+		carry = nBytes % sizeof(T);
+		if(carry > 0) memmove((char*)block.data(), (char*)(block.data()+nWords), carry);
+	}
+
+	return true;
+}
+
+template <typename T>
+bool scan(mappedFile &input_, const unsigned long long &foffset_, unsigned long long &buff_count, unsigned long long &good_buff_count, unsigned long long &total_count){
+	scanState state;
+
+	bool retval = forEachSpan<T>(input_, foffset_, [&](const T *begin_, const T *end_, const unsigned long long &){
+		go<T>(begin_, end_, state, buff_count, good_buff_count, total_count);
+	}, swap_bytes);
+	raw_output.flush();
+
+	if(buff_count > 1){
+		std::cout << " Buffer Size: " << state.word_count << " words\n";
+		std::cout << "============================================================================================================================\n";
+	}
+
+	return retval;
+}
+
+/** Display only every stride_'th buffer, starting at byte offset foffset_. Each sampled
+  * buffer is read with a single pread() call, so only the sampled buffers are ever read
+  * from disk. Sampled positions which do not begin with a buffer header are resynchronized
+  * on the first header in the block, and later samples are taken relative to that header.
+  */
+template <typename T>
+bool sample(mappedFile &input_, const unsigned long long &foffset_, const unsigned long long &stride_, unsigned long long &buff_count, unsigned long long &good_buff_count, unsigned long long &total_count){
+	const unsigned long long fileSize = input_.getFileSize();
+	if(fileSize == 0){
+		std::cout << " ERROR: Buffer sampling requires a regular (seekable) input file!\n";
+		return false;
+	}
+
+	unsigned long long stop = fileSize;
+	if(word_limit > 0 && foffset_+word_limit*sizeof(T) < stop) stop = foffset_+word_limit*sizeof(T);
+
+	const size_t bufferBytes = ldfBufferLength*4;
+	std::vector<unsigned int> block(ldfBufferLength);
+	scanState state;
+
+	// Read a block, reversing the byte order of every word if requested.
+	auto readBlock = [&](const unsigned long long &pos_) -> size_t {
+		size_t nRead = input_.readAt((char*)block.data(), bufferBytes, pos_);
+		if(swap_bytes) byteSwap((T*)block.data(), (T*)block.data(), nRead/sizeof(T));
+		return nRead;
+	};
+
+	for(unsigned long long pos = foffset_; pos < stop; pos += stride_*bufferBytes){
+		size_t nBytes = readBlock(pos);
+		size_t nWords = nBytes/4;
+
+		size_t first = 0;
+		while(first < nWords && !isBufferHeader(block[first])) first++;
+		if(first == nWords){ // No buffer header in this block.
+			if(nBytes < bufferBytes) break;
+			continue;
+		}
+		if(first > 0){
+			pos += first*4;
+			if(pos >= stop) break; // The next header is beyond the end of the sampled range.
+			nBytes = readBlock(pos);
+		}
+		if(pos+nBytes > stop) nBytes = stop-pos;
+
+		// Number the buffer by its position in an undamaged file.
+		buffer_base = pos/bufferBytes-buff_count;
+		go<T>((const T*)block.data(), (const T*)((const char*)block.data()+nBytes-nBytes%sizeof(T)), state, buff_count, good_buff_count, total_count);
+	}
+	raw_output.flush();
+
+	if(buff_count > 0){
+		std::cout << " Buffer Size: " << state.word_count << " words\n";
+		std::cout << "============================================================================================================================\n";
+	}
+
+	return true;
+}
+
+/// A search match and its surrounding context words.
+template <typename T>
+struct searchHit{
+	unsigned long long offset; ///< Word offset of the match in the file.
+	std::vector<T> words; ///< Leading context, the match, and trailing context.
+	unsigned int needed; ///< Number of trailing context words still to be read.
+};
+
+/// Search state which must persist between consecutive spans of the input file.
+template <typename T>
+struct searchState{
+	std::vector<T> history; ///< The last context_before words of the previous span.
+	std::vector<searchHit<T> > pending; ///< Matches which are still waiting on trailing context words.
+	unsigned long long num_matches;
+
+	searchState() : num_matches(0) { }
+};
+
+template <typename T>
+void printHit(const searchHit<T> &hit_){
+	raw_output.put(' ');
+	raw_output.putDecimal(hit_.offset);
+	raw_output.put(":  ", 3);
+	for(typename std::vector<T>::const_iterator iter = hit_.words.begin(); iter != hit_.words.end(); ++iter){
+		const T word = (swap_bytes ? byteSwap(*iter) : *iter);
+		raw_output.putHex(word);
+		raw_output.put("  ", 2);
+		if(convert){
+			raw_output.putAscii(word);
+			raw_output.put("  ", 2);
+		}
+	}
+	raw_output.put('\n');
+}
+
+/** Report every match of a word searcher (wordSearch or sequenceSearch) in a span
+  * of words, along with its context. Only the matches are counted if count_only is set.
+  */
+template <typename T, typename M>
+void search(const T *begin_, const T *end_, const unsigned long long &offset_, const M &searcher_, searchState<T> &state){
+	const size_t length = end_-begin_;
+	const size_t match_length = searcher_.getLength();
+
+	if(count_only){
+		for(const T *ptr = searcher_.find(begin_, end_); ptr != end_; ptr = searcher_.find(ptr+1, end_))
+			state.num_matches++;
+		return;
+	}
+
+	// Complete the trailing context of matches from the previous span.
+	size_t nComplete = 0;
+	for(typename std::vector<searchHit<T> >::iterator iter = state.pending.begin(); iter != state.pending.end(); ++iter){
+		size_t nCopy = (iter->needed < length ? iter->needed : length);
+		iter->words.insert(iter->words.end(), begin_, begin_+nCopy);
+		iter->needed -= nCopy;
+		if(iter->needed == 0) nComplete++;
+	}
+	for(size_t i = 0; i < nComplete; i++) // Matches are completed in order.
+		printHit(state.pending[i]);
+	state.pending.erase(state.pending.begin(), state.pending.begin()+nComplete);
+
+	searchHit<T> hit;
+	for(const T *ptr = searcher_.find(begin_, end_); ptr != end_; ptr = searcher_.find(ptr+1, end_)){
+		size_t index = ptr-begin_;
+		hit.offset = offset_+index;
+		hit.words.clear();
+
+		// Leading context may reach back into the previous span.
+		if(index < context_before){
+			size_t nHistory = context_before-index;
+			if(nHistory > state.history.size()) nHistory = state.history.size();
+			hit.words.insert(hit.words.end(), state.history.end()-nHistory, state.history.end());
+			hit.words.insert(hit.words.end(), begin_, ptr+match_length);
+		}
+		else{ hit.words.insert(hit.words.end(), ptr-context_before, ptr+match_length); }
+
+		// Trailing context may reach forward into the next span.
+		size_t nAfter = (context_after < length-index-match_length ? context_after : length-index-match_length);
+		hit.words.insert(hit.words.end(), ptr+match_length, ptr+match_length+nAfter);
+		hit.needed = context_after-nAfter;
+
+		if(hit.needed > 0 || !state.pending.empty()) state.pending.push_back(hit);
+		else printHit(hit);
+		state.num_matches++;
+	}
+
+	// Save the tail of this span for the leading context of the next one.
+	if(context_before > 0){
+		if(length >= context_before){ state.history.assign(end_-context_before, end_); }
+		else{
+			state.history.insert(state.history.end(), begin_, end_);
+			if(state.history.size() > context_before)
+				state.history.erase(state.history.begin(), state.history.end()-context_before);
+		}
+	}
+}
+
+template <typename T, typename M>
+bool search(mappedFile &input_, const unsigned long long &foffset_, const M &searcher_, unsigned long long &total_count){
+	searchState<T> state;
+	bool retval = forEachSpan<T>(input_, foffset_, [&](const T *begin_, const T *end_, const unsigned long long &offset_){
+		search<T>(begin_, end_, offset_, searcher_, state);
+		total_count += end_-begin_;
+	});
+
+	// Print any matches which were cut short by the end of the file.
+	for(typename std::vector<searchHit<T> >::iterator iter = state.pending.begin(); iter != state.pending.end(); ++iter)
+		printHit(*iter);
+	raw_output.flush();
+
+	std::cout << "\n Found " << state.num_matches << " matches in " << total_count << " " << sizeof(T) << " byte words\n";
+
+	return retval;
+}
+
+template <typename T>
+bool search(mappedFile &input_, const unsigned long long &foffset_, unsigned long long &total_count){
+	const T max_value = (T)(-1);
+
+	if(!search_pattern.empty()){
+		// Sequences may straddle the boundary between streamed blocks, so require a single span.
+		if(!input_.isMapped()){
+			std::cout << " ERROR: Sequence search requires a regular (seekable) input file!\n";
+			return false;
+		}
+		sequenceSearch<T> searcher;
+		for(std::vector<std::pair<unsigned long long, unsigned long long> >::iterator iter = search_pattern.begin(); iter != search_pattern.end(); ++iter){
+			if((iter->first & iter->second) > max_value){
+				std::cout << " ERROR: Sequence value " << iter->first << " does not fit in a " << sizeof(T) << " byte word!\n";
+				return false;
+			}
+			// Search the file in its own byte order by swapping the pattern instead of the data.
+			if(swap_bytes) searcher.add(byteSwap((T)iter->first), byteSwap((T)iter->second));
+			else searcher.add((T)iter->first, (T)iter->second);
+		}
+		return search<T>(input_, foffset_, searcher, total_count);
+	}
+
+	wordSearch<T> searcher;
+	for(std::vector<unsigned long long>::iterator iter = search_list.begin(); iter != search_list.end(); ++iter){
+		if(*iter > max_value){
+			std::cout << " WARNING: Search value " << *iter << " does not fit in a " << sizeof(T) << " byte word!\n";
+			continue;
+		}
+		searcher.add(swap_bytes ? byteSwap((T)(*iter)) : (T)(*iter));
+	}
+	return search<T>(input_, foffset_, searcher, total_count);
+}
+
+/// Per buffer type statistics accumulated by a single census worker.
+struct censusCounts{
+	unsigned long long count[numBufferTypes]; ///< Number of buffers of each type.
+	unsigned long long words[numBufferTypes]; ///< Total number of words in buffers of each type.
+	unsigned long long bad[numBufferTypes]; ///< Number of buffers of each type with the wrong length.
+	unsigned long long numBuffers; ///< Total number of buffers seen by this worker.
+	std::vector<std::pair<unsigned long long, bufferInfo> > anomalies; ///< Local buffer number and location of bad buffers.
+
+	censusCounts() : numBuffers(0) {
+		for(unsigned int i = 0; i < numBufferTypes; i++){
+			count[i] = 0;
+			words[i] = 0;
+			bad[i] = 0;
+		}
+	}
+};
+
+/** Count all ldf buffers in the file by type using multiple threads and report
+  * the number of buffers, the total number of words and the number of anomalous
+  * buffer lengths for each buffer type, starting at byte offset foffset_. Always
+  * uses 4 byte words.
+  */
+bool census(mappedFile &input_, const unsigned long long &foffset_){
+	if(!input_.isMapped()){
+		std::cout << " ERROR: Buffer census requires a regular (seekable) input file!\n";
+		return false;
+	}
+
+	if(foffset_ >= input_.getSize()){
+		std::cout << " ERROR: Start word is beyond the end of the file!\n";
+		return false;
+	}
+	const unsigned int *words = (const unsigned int*)(input_.getData()+foffset_);
+	const size_t nWords = (input_.getSize()-foffset_)/4;
+
+	bufferScan scanner(words, nWords, swap_bytes);
+	std::vector<censusCounts> counts(num_threads);
+	size_t nChunks = scanner.walkParallel(num_threads, [&](const size_t &chunk_, const bufferInfo &buff_){
+		censusCounts &local = counts[chunk_];
+		int index = getBufferTypeIndex(buff_.type);
+		local.count[index]++;
+		local.words[index] += buff_.length;
+		if(!buff_.valid()){
+			local.bad[index]++;
+			if(local.anomalies.size() < max_anomalies)
+				local.anomalies.push_back(std::make_pair(local.numBuffers, buff_));
+		}
+		local.numBuffers++;
+	});
+	counts.resize(nChunks);
+
+	// Merge the results of all workers.
+	censusCounts total;
+	std::vector<std::pair<unsigned long long, bufferInfo> > anomalies;
+	for(std::vector<censusCounts>::iterator iter = counts.begin(); iter != counts.end(); ++iter){
+		for(unsigned int i = 0; i < numBufferTypes; i++){
+			total.count[i] += iter->count[i];
+			total.words[i] += iter->words[i];
+			total.bad[i] += iter->bad[i];
+		}
+		for(std::vector<std::pair<unsigned long long, bufferInfo> >::iterator anomaly = iter->anomalies.begin(); anomaly != iter->anomalies.end(); ++anomaly){
+			if(anomalies.size() < max_anomalies)
+				anomalies.push_back(std::make_pair(total.numBuffers+anomaly->first, anomaly->second));
+		}
+		total.numBuffers += iter->numBuffers;
+	}
+
+	unsigned long long totalWords = 0;
+	unsigned long long totalBad = 0;
+	std::cout << "\n Buffer census of " << nWords << " words using " << nChunks << " threads\n";
+	std::cout << "  Type         Count           Words       Bad\n";
+	for(unsigned int i = 0; i < numBufferTypes; i++){
+		std::cout << "  \"" << bufferNames[i] << "\"" << std::setw(12) << total.count[i] << std::setw(16) << total.words[i] << std::setw(10) << total.bad[i] << std::endl;
+		totalWords += total.words[i];
+		totalBad += total.bad[i];
+	}
+	std::cout << "  Total " << std::setw(12) << total.numBuffers << std::setw(16) << totalWords << std::setw(10) << totalBad << std::endl;
+
+	if(scanner.getFirstBuffer() > 0)
+		std::cout << "\n WARNING: Found " << scanner.getFirstBuffer() << " words before the first buffer header!\n";
+
+	if(!anomalies.empty()){
+		std::cout << "\n Anomalous buffer lengths:\n";
+		for(std::vector<std::pair<unsigned long long, bufferInfo> >::iterator iter = anomalies.begin(); iter != anomalies.end(); ++iter){
+			std::cout << "  Buffer no. " << iter->first+1 << " \"" << bufferNames[getBufferTypeIndex(iter->second.type)] << "\" at word " << (foffset_+iter->second.offset*4)/4;
+			std::cout << " (byte " << foffset_+iter->second.offset*4 << ") contains " << iter->second.length << " words [delta=" << (long long)iter->second.length-ldfBufferLength << "]\n";
+		}
+		if(totalBad > anomalies.size())
+			std::cout << "  ... and " << totalBad-anomalies.size() << " more\n";
+	}
+
+	return true;
+}
+
+/// Cheap statistics of the contents of a single buffer.
+struct bufferStats{
+	bufferInfo buffer; ///< Location and length of the buffer.
+	float zeroFraction; ///< Fraction of payload words which are zero.
+	float entropy; ///< Shannon entropy of the payload bytes (bits per byte).
+	unsigned int numDelimiters; ///< Number of 0xFFFFFFFF words in the payload.
+	bool padded; ///< Set to true if the buffer contents are followed only by 0xFFFFFFFF padding.
+};
+
+/// Compute the statistics of the payload of a buffer, given a pointer to the start of the buffer (in native byte order).
+bufferStats getBufferStats(const unsigned int *buffer_, const bufferInfo &buff_){
+	bufferStats stats;
+	stats.buffer = buff_;
+	stats.zeroFraction = 0;
+	stats.entropy = 0;
+	stats.numDelimiters = 0;
+	stats.padded = false;
+	if(buff_.length <= 2) return stats;
+
+	const unsigned int *begin = buffer_+2;
+	const unsigned int *end = buffer_+buff_.length;
+	const size_t nWords = end-begin;
+
+	unsigned int zeros = 0;
+	unsigned int byteCounts[256] = {0};
+	for(const unsigned int *ptr = begin; ptr != end; ++ptr){
+		const unsigned int word = *ptr;
+		zeros += (word == 0);
+		stats.numDelimiters += (word == 0xFFFFFFFF);
+		byteCounts[word & 0xFF]++;
+		byteCounts[(word >> 8) & 0xFF]++;
+		byteCounts[(word >> 16) & 0xFF]++;
+		byteCounts[word >> 24]++;
+	}
+
+	const double nBytes = 4.0*nWords;
+	double entropy = 0;
+	for(int i = 0; i < 256; i++){
+		if(byteCounts[i] == 0) continue;
+		double p = byteCounts[i]/nBytes;
+		entropy -= p*std::log2(p);
+	}
+
+	stats.zeroFraction = (float)zeros/nWords;
+	stats.entropy = (float)entropy;
+
+	// The chunks of a DATA buffer may fill it completely. Everything following the last chunk must be padding.
+	const unsigned int *padding = end-1;
+	if(buff_.type == DATA){
+		padding = begin;
+		while(padding+3 <= end && *padding != (unsigned int)ENDBUFF){
+			const unsigned int chunkSize = *padding/4;
+			if(*padding % 4 != 0 || chunkSize < 3 || chunkSize > (size_t)(end-padding)) return stats;
+			padding += chunkSize;
+		}
+	}
+	stats.padded = true;
+	for(const unsigned int *ptr = padding; ptr < end; ++ptr){
+		if(*ptr != (unsigned int)ENDBUFF){
+			stats.padded = false;
+			break;
+		}
+	}
+	return stats;
+}
+
+/// Running mean and standard deviation of a buffer statistic.
+struct runningStats{
+	double sum; ///< Sum of all values.
+	double sumSquares; ///< Sum of the squares of all values.
+	unsigned long long count; ///< Number of values.
+
+	runningStats() : sum(0), sumSquares(0), count(0) { }
+
+	void add(const double &value_){ sum += value_; sumSquares += value_*value_; count++; }
+
+	double mean() const { return (count > 0 ? sum/count : 0); }
+
+	double stddev() const {
+		if(count < 2) return 0;
+		double var = (sumSquares-sum*sum/count)/(count-1);
+		return (var > 0 ? std::sqrt(var) : 0);
+	}
+
+	/// Return true if a value is more than outlier_sigma standard deviations from the mean.
+	bool outlier(const double &value_) const {
+		double sigma = this->stddev();
+		if(sigma == 0) return (count > 1 && value_ != this->mean());
+		return (std::fabs(value_-this->mean()) > outlier_sigma*sigma);
+	}
+};
+
+/** Compute the zero fraction, byte entropy, number of 0xFFFFFFFF words and the trailing
+  * padding of every buffer in parallel. Buffers with the wrong length or missing padding,
+  * and buffers whose statistics are outliers compared to all buffers of the same type,
+  * are reported along with their file offsets. Starts at byte offset foffset_ and
+  * always uses 4 byte words.
+  */
+bool triage(mappedFile &input_, const unsigned long long &foffset_){
+	if(!input_.isMapped()){
+		std::cout << " ERROR: Buffer triage requires a regular (seekable) input file!\n";
+		return false;
+	}
+
+	if(foffset_ >= input_.getSize()){
+		std::cout << " ERROR: Start word is beyond the end of the file!\n";
+		return false;
+	}
+	const unsigned int *words = (const unsigned int*)(input_.getData()+foffset_);
+	const size_t nWords = (input_.getSize()-foffset_)/4;
+
+	bufferScan scanner(words, nWords, swap_bytes);
+	std::vector<std::vector<bufferStats> > results(num_threads);
+	std::vector<std::vector<unsigned int> > scratch(num_threads);
+	size_t nChunks = scanner.walkParallel(num_threads, [&](const size_t &chunk_, const bufferInfo &buff_){
+		results[chunk_].push_back(getBufferStats(getBufferWords(words, buff_, scratch[chunk_]), buff_));
+	});
+	results.resize(nChunks);
+
+	// Accumulate the distribution of each statistic for every buffer type.
+	runningStats zeroStats[numBufferTypes];
+	runningStats entropyStats[numBufferTypes];
+	runningStats delimiterStats[numBufferTypes];
+	for(std::vector<std::vector<bufferStats> >::iterator chunk = results.begin(); chunk != results.end(); ++chunk){
+		for(std::vector<bufferStats>::iterator iter = chunk->begin(); iter != chunk->end(); ++iter){
+			int index = getBufferTypeIndex(iter->buffer.type);
+			zeroStats[index].add(iter->zeroFraction);
+			entropyStats[index].add(iter->entropy);
+			delimiterStats[index].add(iter->numDelimiters);
+		}
+	}
+
+	std::cout << "\n Buffer triage of " << nWords << " words using " << nChunks << " threads\n";
+	std::cout << "  Type         Count  Zeros (%)  Entropy  0xFFFFFFFF\n";
+	std::cout << std::fixed;
+	for(unsigned int i = 0; i < numBufferTypes; i++){
+		if(zeroStats[i].count == 0) continue;
+		std::cout << "  \"" << bufferNames[i] << "\"" << std::setw(12) << zeroStats[i].count << std::setprecision(2) << std::setw(11) << 100*zeroStats[i].mean();
+		std::cout << std::setprecision(3) << std::setw(9) << entropyStats[i].mean() << std::setprecision(1) << std::setw(12) << delimiterStats[i].mean() << std::endl;
+	}
+
+	// Flag suspicious buffers.
+	unsigned long long buff_count = 0;
+	unsigned long long num_flagged = 0;
+	for(std::vector<std::vector<bufferStats> >::iterator chunk = results.begin(); chunk != results.end(); ++chunk){
+		for(std::vector<bufferStats>::iterator iter = chunk->begin(); iter != chunk->end(); ++iter){
+			buff_count++;
+			int index = getBufferTypeIndex(iter->buffer.type);
+			std::string reasons;
+			if(!iter->buffer.valid()) reasons += " length";
+			if(!iter->padded) reasons += " padding";
+			if(zeroStats[index].outlier(iter->zeroFraction)) reasons += " zeros";
+			if(entropyStats[index].outlier(iter->entropy)) reasons += " entropy";
+			if(delimiterStats[index].outlier(iter->numDelimiters)) reasons += " 0xFFFFFFFF";
+			if(reasons.empty()) continue;
+
+			if(num_flagged++ == 0) std::cout << "\n Suspicious buffers:\n";
+			if(num_flagged > max_anomalies) continue;
+			std::cout << "  Buffer no. " << buff_count << " \"" << bufferNames[index] << "\" at word " << (foffset_+iter->buffer.offset*4)/4;
+			std::cout << " (byte " << foffset_+iter->buffer.offset*4 << "), " << iter->buffer.length << " words, zeros=" << std::setprecision(2) << 100*iter->zeroFraction;
+			std::cout << "%, entropy=" << std::setprecision(3) << iter->entropy << ", 0xFFFFFFFF=" << iter->numDelimiters << " [" << reasons.substr(1) << "]\n";
+		}
+	}
+	std::cout.unsetf(std::ios_base::floatfield);
+	if(num_flagged > max_anomalies)
+		std::cout << "  ... and " << num_flagged-max_anomalies << " more\n";
+	std::cout << "\n Flagged " << num_flagged << " of " << buff_count << " buffers\n";
+
+	if(scanner.getFirstBuffer() > 0)
+		std::cout << "\n WARNING: Found " << scanner.getFirstBuffer() << " words before the first buffer header!\n";
+
+	return true;
+}
+
+/// Word value histogram accumulated by a single histogram worker.
+struct histogramCounts{
+	std::vector<unsigned long long> dense; ///< One bin per field value, for narrow fields.
+	std::unordered_map<unsigned long long, unsigned long long> sparse; ///< Counts of the values seen, for wide fields.
+	unsigned long long total; ///< Number of words histogrammed.
+
+	histogramCounts() : total(0) { }
+};
+
+/** Histogram the values of a bit field (selected by mask_) of every word of type T in
+  * the file, or only of the payload of buffers of type buffer_select. The file is split
+  * into one chunk per thread, each worker fills its own histogram, and the histograms are
+  * merged at the end. Fields of up to 24 bits use one bin per value, and wider fields use
+  * a hash table of the values which actually occur.
+  */
+template <typename T>
+bool histogram(mappedFile &input_, const unsigned long long &foffset_, const unsigned long long &mask_){
+	if(!input_.isMapped()){
+		std::cout << " ERROR: Histogram mode requires a regular (seekable) input file!\n";
+		return false;
+	}
+	if(mask_ > (T)(-1)){
+		std::cout << " ERROR: Histogram mask " << convert_to_hex(mask_) << " does not fit in a " << sizeof(T) << " byte word!\n";
+		return false;
+	}
+
+	const unsigned long long byteOffset = foffset_*sizeof(T);
+	if(byteOffset >= input_.getSize()){
+		std::cout << " ERROR: Start word is beyond the end of the file!\n";
+		return false;
+	}
+
+	const T mask = (mask_ != 0 ? (T)mask_ : (T)(-1));
+	const int shift = __builtin_ctzll(mask);
+	const unsigned long long maxValue = (unsigned long long)mask >> shift;
+	const bool dense = (maxValue < (1ULL << 24));
+
+	std::vector<histogramCounts> counts(num_threads);
+	for(std::vector<histogramCounts>::iterator iter = counts.begin(); iter != counts.end(); ++iter){
+		if(dense) iter->dense.assign(maxValue+1, 0);
+	}
+
+	auto count = [&](const T *begin_, const T *end_, histogramCounts &local){
+		if(dense){
+			unsigned long long *bins = local.dense.data();
+			for(const T *ptr = begin_; ptr != end_; ++ptr)
+				bins[(*ptr & mask) >> shift]++;
+		}
+		else{
+			for(const T *ptr = begin_; ptr != end_; ++ptr)
+				local.sparse[(*ptr & mask) >> shift]++;
+		}
+	};
+
+	// Count nWords_ words starting at begin_. Words which must be byte swapped or which are not aligned
+	// for type T are copied into the worker's scratch block a small block at a time, so it stays in cache.
+	const size_t scratchSize = 65536;
+	std::vector<std::vector<T> > scratch(num_threads);
+	auto fill = [&](const char *begin_, const size_t &nWords_, histogramCounts &local, std::vector<T> &scratch_){
+		if(swap_bytes || (size_t)begin_ % sizeof(T) != 0){
+			if(scratch_.empty()) scratch_.resize(scratchSize);
+			for(size_t done = 0; done < nWords_; ){
+				size_t nWords = (nWords_-done < scratchSize ? nWords_-done : scratchSize);
+				memcpy(scratch_.data(), begin_+done*sizeof(T), nWords*sizeof(T));
+				if(swap_bytes) byteSwap(scratch_.data(), scratch_.data(), nWords);
+				count(scratch_.data(), scratch_.data()+nWords, local);
+				done += nWords;
+			}
+		}
+		else count((const T*)begin_, (const T*)begin_+nWords_, local);
+		local.total += nWords_;
+	};
+
+	size_t nChunks;
+	if(buffer_select == 0){ // Split the file into equal chunks of words.
+		const char *begin = input_.getData()+byteOffset;
+		const size_t nWords = (input_.getSize()-byteOffset)/sizeof(T);
+		nChunks = (nWords < num_threads ? 1 : num_threads);
+		std::vector<std::thread> workers;
+		for(size_t i = 0; i < nChunks; i++){
+			const char *start = begin+((nWords*i)/nChunks)*sizeof(T);
+			const size_t length = (nWords*(i+1))/nChunks-(nWords*i)/nChunks;
+			workers.push_back(std::thread([&fill, &counts, &scratch, start, length, i](){ fill(start, length, counts[i], scratch[i]); }));
+		}
+		for(size_t i = 0; i < nChunks; i++)
+			workers[i].join();
+	}
+	else{ // Only histogram the payload of the selected buffers (the whole words of type T which fit in it).
+		const unsigned long long wordOffset = byteOffset/4;
+		const unsigned int *words = (const unsigned int*)input_.getData()+wordOffset;
+		bufferScan scanner(words, input_.getSize()/4-wordOffset, swap_bytes);
+		nChunks = scanner.walkParallel(num_threads, [&](const size_t &chunk_, const bufferInfo &buff_){
+			if(buff_.type != buffer_select || buff_.length <= 2) return;
+			fill((const char*)(words+buff_.offset+2), (buff_.length-2)*4/sizeof(T), counts[chunk_], scratch[chunk_]);
+		});
+	}
+	counts.resize(nChunks);
+
+	// Merge the results of all workers.
+	histogramCounts total;
+	std::vector<std::pair<unsigned long long, unsigned long long> > bins;
+	for(std::vector<histogramCounts>::iterator iter = counts.begin(); iter != counts.end(); ++iter){
+		total.total += iter->total;
+		if(dense){
+			if(total.dense.empty()) total.dense.swap(iter->dense);
+			else{
+				for(size_t i = 0; i <= maxValue; i++)
+					total.dense[i] += iter->dense[i];
+			}
+		}
+		else{
+			for(std::unordered_map<unsigned long long, unsigned long long>::iterator bin = iter->sparse.begin(); bin != iter->sparse.end(); ++bin)
+				total.sparse[bin->first] += bin->second;
+		}
+	}
+	if(dense){
+		for(size_t i = 0; i < total.dense.size(); i++){
+			if(total.dense[i] > 0) bins.push_back(std::make_pair(i, total.dense[i]));
+		}
+	}
+	else{
+		bins.assign(total.sparse.begin(), total.sparse.end());
+		std::sort(bins.begin(), bins.end());
+	}
+
+	// Count how often each bit of the field is set. Stuck bits are never or always set.
+	const int width = (maxValue == 0 ? 1 : 64-__builtin_clzll(maxValue));
+	std::vector<unsigned long long> bitCounts(width, 0);
+	long double sum = 0;
+	for(std::vector<std::pair<unsigned long long, unsigned long long> >::iterator iter = bins.begin(); iter != bins.end(); ++iter){
+		sum += (long double)iter->first*iter->second;
+		for(int bit = 0; bit < width; bit++){
+			if(iter->first & (1ULL << bit)) bitCounts[bit] += iter->second;
+		}
+	}
+
+	std::cout << "\n Histogram of field " << convert_to_hex(mask) << " of " << total.total << " " << sizeof(T) << " byte words using " << nChunks << " threads\n";
+	if(bins.empty()) return true;
+
+	std::cout << "  Distinct values: " << bins.size() << ", min: " << bins.front().first << ", max: " << bins.back().first;
+	std::cout << ", mean: " << std::setprecision(6) << (double)(sum/total.total) << std::endl;
+
+	std::cout << "\n  Bit      Set (%)\n";
+	for(int bit = width-1; bit >= 0; bit--){
+		double fraction = 100.0*bitCounts[bit]/total.total;
+		std::cout << std::setw(5) << bit << std::setw(13) << std::fixed << std::setprecision(3) << fraction;
+		if(bitCounts[bit] == 0 || bitCounts[bit] == total.total) std::cout << "  (stuck)";
+		std::cout << std::endl;
+	}
+	std::cout.unsetf(std::ios_base::floatfield);
+
+	std::cout << "\n         Value         Count\n";
+	for(std::vector<std::pair<unsigned long long, unsigned long long> >::iterator iter = bins.begin(); iter != bins.end(); ++iter){
+		raw_output.putDecimal(iter->first, 14, ' ');
+		raw_output.putDecimal(iter->second, 14, ' ');
+		raw_output.put('\n');
+	}
+	raw_output.flush();
+
+	return true;
+}
+
+/** Copy all buffers of the type given by buffer_select (or of any type) whose buffer
+  * numbers lie in the range [first_, last_] to a new file. Runs of adjacent selected
+  * buffers are copied with a single kernel copy, so the data does not pass through
+  * user space. An existing output file is only overwritten if force_ is set, and
+  * never if it is the input file itself. Always uses 4 byte words.
+  */
+bool extract(mappedFile &input_, const std::string &ofname_, const unsigned long long &first_, const unsigned long long &last_, const bool &force_){
+	if(!input_.isMapped()){
+		std::cout << " ERROR: Buffer extraction requires a regular (seekable) input file!\n";
+		return false;
+	}
+
+	if(!force_ && access(ofname_.c_str(), F_OK) == 0){
+		std::cout << " ERROR: Output file \"" << ofname_ << "\" already exists! Use --force to overwrite it.\n";
+		return false;
+	}
+
+	// The output is only truncated once it is known not to be the (mapped) input file.
+	int fdOut = open(ofname_.c_str(), O_WRONLY | O_CREAT, 0644);
+	if(fdOut < 0){
+		std::cout << " ERROR: Failed to open output file \"" << ofname_ << "\"!\n";
+		return false;
+	}
+	if(isSameFile(input_.getDescriptor(), fdOut)){
+		std::cout << " ERROR: Output file \"" << ofname_ << "\" is the input file!\n";
+		close(fdOut);
+		return false;
+	}
+	if(ftruncate(fdOut, 0) != 0){
+		std::cout << " ERROR: Failed to truncate output file \"" << ofname_ << "\"!\n";
+		close(fdOut);
+		return false;
+	}
+
+	const unsigned int *words = (const unsigned int*)input_.getData();
+	const size_t nWords = input_.getSize()/4;
+
+	unsigned long long buff_count = 0;
+	unsigned long long num_selected = 0;
+	unsigned long long num_spans = 0;
+	unsigned long long num_bytes = 0;
+
+	// The current run of adjacent selected buffers (in words).
+	size_t spanStart = 0;
+	size_t spanStop = 0;
+
+	bool retval = true;
+	auto flushSpan = [&](){
+		if(spanStop == spanStart) return;
+		if(retval && !copyFileRange(input_.getDescriptor(), spanStart*4ULL, fdOut, (spanStop-spanStart)*4ULL)){
+			std::cout << " ERROR: Failed to write to output file \"" << ofname_ << "\"!\n";
+			retval = false;
+		}
+		num_spans++;
+		num_bytes += (spanStop-spanStart)*4ULL;
+		spanStart = spanStop;
+	};
+
+	bufferScan scanner(words, nWords, swap_bytes);
+	scanner.split(1);
+	auto processBuffer = [&](const size_t &, const bufferInfo &buff_){
+		buff_count++;
+		if(buff_count < first_ || buff_count > last_) return;
+		if(buffer_select != 0 && buff_.type != buffer_select) return;
+		num_selected++;
+		if(buff_.offset != spanStop) flushSpan();
+		if(spanStop == spanStart) spanStart = buff_.offset;
+		spanStop = buff_.offset+buff_.length;
+	};
+	if(scanner.getNumChunks() > 0) scanner.walk(0, processBuffer);
+	flushSpan();
+
+	close(fdOut);
+
+	if(retval) std::cout << " Extracted " << num_selected << " of " << buff_count << " buffers (" << num_bytes << " bytes in " << num_spans << " spans) to \"" << ofname_ << "\"\n";
+
+	return retval;
+}
+
+/** List all buffers of a span of words in file order. Any words before the first
+  * buffer header are listed as buffer zero (with a type word of zero).
+  * \param[in]  words_   Pointer to the start of the span.
+  * \param[in]  nWords_  The number of words in the span.
+  * \param[out] buffers_ The list of buffers.
+  * \return Nothing.
+  */
+void listBuffers(const unsigned int *words_, const size_t &nWords_, std::vector<bufferInfo> &buffers_){
+	bufferScan scanner(words_, nWords_, swap_bytes);
+	scanner.split(1);
+	if(scanner.getFirstBuffer() > 0)
+		buffers_.push_back(bufferInfo(0, 0, scanner.getFirstBuffer()));
+	auto addBuffer = [&](const size_t &, const bufferInfo &buff_){ buffers_.push_back(buff_); };
+	if(scanner.getNumChunks() > 0) scanner.walk(0, addBuffer);
+}
+
+/** Compare two ldf files buffer by buffer. Both files are scanned for buffer headers
+  * and their buffers are paired in file order. When a pair of buffers differs, the
+  * files are resynchronized on the nearest pair of identical buffers within the next
+  * few buffers of each file, so a buffer which was padded, split, inserted or removed
+  * (e.g. by ldfFixer) only affects the buffers around it. Only the differing words of
+  * paired buffers are displayed, and buffers without a partner are listed separately.
+  * Always uses 4 byte words.
+  */
+bool diff(mappedFile &input_, const std::string &fname2_){
+	const size_t max_rows = 16; // Maximum number of differing words to display per buffer.
+	const size_t max_resync = 16; // Maximum number of buffers to look ahead in each file when resynchronizing.
+
+	mappedFile input2;
+	if(!input2.open(fname2_)){
+		std::cout << " ERROR: Failed to open input file \"" << fname2_ << "\"!\n";
+		return false;
+	}
+	if(!input_.isMapped() || !input2.isMapped()){
+		std::cout << " ERROR: Binary diff requires two regular (seekable) input files!\n";
+		return false;
+	}
+
+	const unsigned int *words1 = (const unsigned int*)input_.getData();
+	const unsigned int *words2 = (const unsigned int*)input2.getData();
+	const size_t nWords1 = input_.getSize()/4;
+	const size_t nWords2 = input2.getSize()/4;
+
+	std::vector<bufferInfo> buffers1, buffers2;
+	listBuffers(words1, nWords1, buffers1);
+	listBuffers(words2, nWords2, buffers2);
+	if(buffers1.empty() || (buffers1.front().type == 0 && buffers1.size() == 1)){
+		std::cout << " ERROR: No buffers found in the first input file!\n";
+		return false;
+	}
+
+	// Buffers are numbered from one, and any leading words are buffer zero.
+	const size_t base1 = (buffers1.front().type == 0 ? 0 : 1);
+	const size_t base2 = (!buffers2.empty() && buffers2.front().type == 0 ? 0 : 1);
+
+	unsigned long long diff_buffers = 0;
+	unsigned long long diff_words = 0;
+	unsigned long long unmatched1 = 0;
+	unsigned long long unmatched2 = 0;
+
+	auto same = [&](const size_t &i_, const size_t &j_) -> bool {
+		return (buffers1[i_].length == buffers2[j_].length && memcmp(words1+buffers1[i_].offset, words2+buffers2[j_].offset, buffers1[i_].length*4) == 0);
+	};
+
+	auto putBuffer = [&](const bufferInfo &buff_, const size_t &number_){
+		raw_output.put("buffer no. ", 11);
+		raw_output.putDecimal(number_);
+		if(buff_.type != 0){
+			raw_output.put(" \"", 2);
+			raw_output.put(bufferNames[getBufferTypeIndex(buff_.type)], 4);
+			raw_output.put('\"');
+		}
+		raw_output.put(" at word ", 9);
+		raw_output.putDecimal(buff_.offset);
+	};
+
+	auto compare = [&](const size_t &i_, const size_t &j_){
+		const bufferInfo &buff1 = buffers1[i_];
+		const bufferInfo &buff2 = buffers2[j_];
+		const unsigned int *ptr1 = words1+buff1.offset;
+		const unsigned int *ptr2 = words2+buff2.offset;
+
+		raw_output.put("\n File 1 ", 9);
+		putBuffer(buff1, i_+base1);
+		raw_output.put(", file 2 ", 9);
+		putBuffer(buff2, j_+base2);
+		raw_output.put('\n');
+
+		const size_t length = (buff1.length > buff2.length ? buff1.length : buff2.length);
+		size_t nDiff = 0;
+		for(size_t i = 0; i < length; i++){
+			if(i < buff1.length && i < buff2.length && ptr1[i] == ptr2[i]) continue;
+			if(nDiff++ < max_rows){
+				raw_output.put("  ", 2);
+				if(i < buff1.length) raw_output.putDecimal(buff1.offset+i, 12);
+				else raw_output.put("            ", 12);
+				raw_output.put(" [", 2);
+				raw_output.putDecimal(i, 4);
+				raw_output.put("]  ", 3);
+				if(i < buff1.length) raw_output.putHex(swap_bytes ? byteSwap(ptr1[i]) : ptr1[i]);
+				else raw_output.put("----------", 10);
+				raw_output.put("  ", 2);
+				if(i < buff2.length) raw_output.putHex(swap_bytes ? byteSwap(ptr2[i]) : ptr2[i]);
+				else raw_output.put("----------", 10);
+				raw_output.put('\n');
+			}
+		}
+		if(nDiff > max_rows){
+			raw_output.put("  ... and ", 10);
+			raw_output.putDecimal(nDiff-max_rows);
+			raw_output.put(" more\n", 6);
+		}
+
+		diff_buffers++;
+		diff_words += nDiff;
+	};
+
+	auto unmatched = [&](const bufferInfo &buff_, const size_t &number_, const char &file_){
+		raw_output.put("\n Only in file ", 15);
+		raw_output.put(file_);
+		raw_output.put(": ", 2);
+		putBuffer(buff_, number_);
+		raw_output.put(" (", 2);
+		raw_output.putDecimal(buff_.length);
+		raw_output.put(" words)\n", 8);
+	};
+
+	std::cout << " Comparing \"" << fname2_ << "\" buffer by buffer\n";
+	std::cout << "  Word no.     [Index]  File 1      File 2\n";
+	const size_t n1 = buffers1.size();
+	const size_t n2 = buffers2.size();
+	size_t i = 0, j = 0;
+	while(i < n1 || j < n2){
+		if(i < n1 && j < n2 && same(i, j)){
+			i++;
+			j++;
+			continue;
+		}
+
+		// Look for the nearest pair of identical buffers, skipping k buffers of file 1 and d-k buffers of file 2.
+		size_t skip1 = (j < n2 ? (i < n1 ? 1 : 0) : n1-i);
+		size_t skip2 = (i < n1 ? (j < n2 ? 1 : 0) : n2-j);
+		bool found = false;
+		for(size_t d = 1; d <= 2*max_resync && !found; d++){
+			for(size_t k = (d > max_resync ? d-max_resync : 0); k <= d && k <= max_resync; k++){
+				if(i+k < n1 && j+d-k < n2 && same(i+k, j+d-k)){
+					skip1 = k;
+					skip2 = d-k;
+					found = true;
+					break;
 				}
-				std::cout << "\n" << padding << temp_string << "  "; 
 			}
-			std::cout << convert_to_hex(word) << "  "; count++;
-			if(convert){ std::cout << convert_to_ascii(word) << "  "; }
 		}
+
+		// Compare the skipped buffers pairwise and list the rest as unmatched.
+		const size_t nPairs = (skip1 < skip2 ? skip1 : skip2);
+		for(size_t p = 0; p < nPairs; p++)
+			compare(i+p, j+p);
+		for(size_t p = nPairs; p < skip1; p++, unmatched1++)
+			unmatched(buffers1[i+p], i+p+base1, '1');
+		for(size_t p = nPairs; p < skip2; p++, unmatched2++)
+			unmatched(buffers2[j+p], j+p+base2, '2');
+		i += skip1;
+		j += skip2;
 	}
+	raw_output.flush();
+
+	std::cout << "\n Compared " << n1 << " buffers (" << nWords1 << " words) with " << n2 << " buffers (" << nWords2 << " words)\n";
+	std::cout << "  Found " << diff_words << " differing words in " << diff_buffers << " buffers\n";
+	if(unmatched1 > 0 || unmatched2 > 0)
+		std::cout << "  Found " << unmatched1 << " buffers only in file 1 and " << unmatched2 << " buffers only in file 2\n";
+	if(nWords1 != nWords2)
+		std::cout << "  WARNING: File lengths differ by " << (long long)nWords2-(long long)nWords1 << " words!\n";
+
+	return true;
+}
+
+/** Walk all DATA buffers in the file, reassemble their spills and decode the Pixie16
+  * list mode channel headers of every module. Reports the number of events for each
+  * crate, slot and channel. Every decoded header is also displayed if show_raw is set.
+  */
+bool decode(mappedFile &input_){
+	if(!input_.isMapped()){
+		std::cout << " ERROR: Channel header decoding requires a regular (seekable) input file!\n";
+		return false;
+	}
+
+	const unsigned int *words = (const unsigned int*)input_.getData();
+	const size_t nWords = input_.getSize()/4;
+
+	// Counters indexed by (crate << 8) + (slot << 4) + channel.
+	std::vector<unsigned long long> events(4096, 0);
+	std::vector<unsigned long long> pileups(4096, 0);
+	std::vector<unsigned long long> traces(4096, 0);
+	std::vector<unsigned long long> saturated(4096, 0);
+
+	unsigned long long total_events = 0;
+	unsigned long long bad_modules = 0;
+	unsigned long long bad_spills = 0;
+
+	spillReader reader;
+	channelHeaders headers;
+
+	if(show_raw) raw_output.put("  Crate Slot Chan  Length            Time    Cfd  Energy  Trace\n");
+
+	auto processModule = [&](const unsigned int &, const unsigned int *data_, const size_t &nData_){
+		if(!headers.decode(data_, nData_)) bad_modules++;
+		for(size_t i = 0; i < headers.size(); i++){
+			size_t index = (headers.crate[i] << 8) + (headers.slot[i] << 4) + headers.channel[i];
+			events[index]++;
+			pileups[index] += headers.pileup[i];
+			traces[index] += (headers.traceLength[i] > 0);
+			saturated[index] += headers.saturated[i];
+		}
+		total_events += headers.size();
+
+		if(!show_raw) return;
+		for(size_t i = 0; i < headers.size(); i++){
+			raw_output.putDecimal(headers.crate[i], 7, ' ');
+			raw_output.putDecimal(headers.slot[i], 5, ' ');
+			raw_output.putDecimal(headers.channel[i], 5, ' ');
+			raw_output.putDecimal(headers.eventLength[i], 8, ' ');
+			raw_output.putDecimal(headers.time[i], 16, ' ');
+			raw_output.putDecimal(headers.cfdTime[i], 7, ' ');
+			raw_output.putDecimal(headers.energy[i], 8, ' ');
+			raw_output.putDecimal(headers.traceLength[i], 7, ' ');
+			raw_output.put('\n');
+		}
+	};
+
+	auto processSpill = [&](const std::vector<unsigned int> &spill_){
+		if(!spillReader::forEachModule(spill_, processModule)) bad_spills++;
+	};
+
+	auto processError = [](const spillReader::STATUS &, const size_t &){ };
+
+	bufferScan scanner(words, nWords, swap_bytes);
+	scanner.split(1);
+	unsigned long long data_buffers = 0;
+	std::vector<unsigned int> scratch;
+	auto processBuffer = [&](const size_t &, const bufferInfo &buff_){
+		if(buff_.type != DATA) return;
+		reader.read(getBufferWords(words, buff_, scratch), buff_.length, processSpill, processError);
+		data_buffers++;
+	};
+	if(scanner.getNumChunks() > 0) scanner.walk(0, processBuffer);
+	raw_output.flush();
+
+	std::cout << "\n Decoded " << total_events << " events in " << reader.getNumSpills() << " spills from " << data_buffers << " DATA buffers\n";
+	std::cout << "  Found " << reader.getNumErrors() << " chunk framing errors, " << bad_spills << " bad spills, and " << bad_modules << " bad modules\n\n";
+	std::cout << "  Crate Slot Chan        Events    Pileup    Traces Saturated\n";
+	for(size_t i = 0; i < events.size(); i++){
+		if(events[i] == 0) continue;
+		std::cout << std::setw(7) << (i >> 8) << std::setw(5) << ((i >> 4) & 0xF) << std::setw(5) << (i & 0xF);
+		std::cout << std::setw(14) << events[i] << std::setw(10) << pileups[i] << std::setw(10) << traces[i] << std::setw(10) << saturated[i] << std::endl;
+	}
+
+	return true;
+}
+
+/// Number of buffers, words and events which fall in a single timeline bin.
+struct rateBin{
+	unsigned long long buffers; ///< Number of DATA buffers.
+	unsigned long long words; ///< Number of event words.
+	unsigned long long events; ///< Number of events.
+
+	rateBin() : buffers(0), words(0), events(0) { }
+
+	rateBin &operator += (const rateBin &other_){
+		buffers += other_.buffers;
+		words += other_.words;
+		events += other_.events;
+		return *this;
+	}
+};
+
+/// Timeline state of a single worker.
+struct timelineWorker{
+	spillReader reader; ///< Reassembles the spills of this worker's DATA buffers.
+	channelHeaders headers; ///< Decoded headers of the current module.
+	std::map<unsigned long long, rateBin> bins; ///< Rates indexed by absolute time bin.
+	std::vector<unsigned int> scratch; ///< The current buffer, if its byte order is reversed.
+	unsigned long long leadingBuffers; ///< DATA buffers which ended before the first event of this worker.
+	unsigned long long firstBin; ///< Bin of the most recent event at the end of the first buffer with an event.
+	unsigned long long lastBin; ///< Bin of the most recent event.
+	bool haveEvent; ///< Set to true once an event has been decoded.
+
+	timelineWorker() : leadingBuffers(0), firstBin(0), lastBin(0), haveEvent(false) { }
+};
+
+/** Print the rate of DATA buffers, event words and events in bins of binTime_ seconds
+  * using the channel timestamps of all events, with the tick length tick_ (in ns). Each
+  * thread reassembles the spills of its own part of the file, finishing the spill which
+  * straddles the end of its part, and decodes the channel headers of every module.
+  * Each buffer is assigned to the time bin of the most recent event which was completed
+  * when the buffer ended. The result does not depend on the number of threads.
+  */
+bool timeline(mappedFile &input_, const double &binTime_, const double &tick_){
+	if(!input_.isMapped()){
+		std::cout << " ERROR: Rate timeline requires a regular (seekable) input file!\n";
+		return false;
+	}
+	if(binTime_ <= 0 || tick_ <= 0){
+		std::cout << " ERROR: Invalid timeline bin width or clock tick!\n";
+		return false;
+	}
+
+	const unsigned int *words = (const unsigned int*)input_.getData();
+	const size_t nWords = input_.getSize()/4;
+	const double binTicks = binTime_*1E9/tick_;
+
+	std::vector<timelineWorker> workers(num_threads);
+
+	// Decode the events of every spill completed in a DATA buffer. If finishing_ is set, only the
+	// spill in progress is completed and true is returned once it has been, without counting the buffer.
+	auto processData = [&](timelineWorker &local, const bufferInfo &buff_, const bool &finishing_){
+		bool completed = false;
+		local.reader.read(getBufferWords(words, buff_, local.scratch), buff_.length, [&](const std::vector<unsigned int> &spill_){
+			if(finishing_ && completed) return;
+			completed = true;
+			spillReader::forEachModule(spill_, [&](const unsigned int &, const unsigned int *data_, const size_t &nData_){
+				local.headers.decode(data_, nData_);
+				for(size_t i = 0; i < local.headers.size(); i++){
+					local.lastBin = (unsigned long long)(local.headers.time[i]/binTicks);
+					rateBin &bin = local.bins[local.lastBin];
+					bin.events++;
+					bin.words += local.headers.eventLength[i];
+				}
+			});
+		}, [](const spillReader::STATUS &, const size_t &){ });
+		if(finishing_ && completed) return true;
+
+		if(local.haveEvent) local.bins[local.lastBin].buffers++;
+		else if(!local.bins.empty()){ // First buffer containing the end of an event.
+			local.haveEvent = true;
+			local.firstBin = local.lastBin;
+			local.bins[local.lastBin].buffers++;
+		}
+		else local.leadingBuffers++;
+		return false;
+	};
+
+	bufferScan scanner(words, nWords, swap_bytes);
+	size_t nChunks = scanner.walkParallel(num_threads, [&](const size_t &chunk_, const bufferInfo &buff_){
+		if(buff_.type == DATA) processData(workers[chunk_], buff_, false);
+	});
+	workers.resize(nChunks);
+
+	// Finish the spills which straddle the end of each chunk. Buffers before the one which completes
+	// the spill are counted here, and are later removed from the leading buffers of the next chunks.
+	std::vector<unsigned long long> continuedBuffers(nChunks, 0);
+	for(size_t i = 0; i+1 < nChunks; i++){
+		if(!workers[i].reader.inProgress()) continue;
+		size_t pos = scanner.getChunkEnd(i);
+		while(pos < nWords){
+			size_t nextPos = scanner.next(pos, nWords);
+			if(scanner.getWord(pos) == DATA){
+				if(processData(workers[i], bufferInfo(pos, DATA, nextPos-pos), true)) break;
+				continuedBuffers[i]++;
+			}
+			pos = nextPos;
+		}
+	}
+
+	// Merge the results of all workers in file order. The remaining leading buffers of each
+	// worker belong to the most recent event of the preceding workers.
+	std::map<unsigned long long, rateBin> bins;
+	unsigned long long carried = 0;
+	unsigned long long skipped = 0;
+	bool haveBin = false;
+	unsigned long long currentBin = 0;
+	for(size_t i = 0; i < nChunks; i++){
+		const timelineWorker &local = workers[i];
+		for(std::map<unsigned long long, rateBin>::const_iterator bin = local.bins.begin(); bin != local.bins.end(); ++bin)
+			bins[bin->first] += bin->second;
+
+		unsigned long long leading = local.leadingBuffers;
+		unsigned long long nSkip = (skipped < leading ? skipped : leading);
+		leading -= nSkip;
+		skipped -= nSkip;
+
+		if(haveBin) bins[currentBin].buffers += leading;
+		else carried += leading;
+		if(!local.bins.empty()){
+			if(!haveBin){
+				bins[(local.haveEvent ? local.firstBin : local.lastBin)].buffers += carried;
+				carried = 0;
+			}
+			haveBin = true;
+			currentBin = local.lastBin;
+		}
+		skipped += continuedBuffers[i];
+	}
+	if(bins.empty()){
+		std::cout << " No events were found in DATA buffers!\n";
+		return true;
+	}
+
+	rateBin total;
+	std::cout << "\n Rate timeline using " << nChunks << " threads (" << binTime_ << " s bins, " << tick_ << " ns ticks)\n";
+	std::cout << "        Time (s)     Buffers/s         Words/s        Events/s\n";
+	const unsigned long long firstBin = bins.begin()->first;
+	unsigned long long previousBin = firstBin;
+	for(std::map<unsigned long long, rateBin>::iterator iter = bins.begin(); iter != bins.end(); ++iter){
+		if(iter->first > previousBin+1) // Flag gaps in the data (e.g. beam trips or stalls).
+			std::cout << "  ... no events for " << (iter->first-previousBin-1)*binTime_ << " s\n";
+		std::cout << std::setw(16) << (iter->first-firstBin)*binTime_ << std::setw(14) << iter->second.buffers/binTime_;
+		std::cout << std::setw(16) << iter->second.words/binTime_ << std::setw(16) << iter->second.events/binTime_ << std::endl;
+		total += iter->second;
+		previousBin = iter->first;
+	}
+
+	const double duration = (bins.rbegin()->first-firstBin+1)*binTime_;
+	std::cout << "\n  Total: " << total.buffers << " DATA buffers, " << total.words << " event words, and " << total.events << " events in " << duration << " s\n";
+
+	return true;
+}
+
+void follow_interrupt(int){
+	follow_running = 0;
+}
+
+/** Follow an ldf file which is still being written and print a summary of each
+  * buffer as it is appended to the file. Only newly appended data is read. Stops
+  * when the end of file buffers are written or when the user presses ctrl-c. Starts
+  * at byte offset foffset_ and always uses 4 byte words.
+  */
+bool follow(const std::string &fname_, const unsigned long long &foffset_){
+	const size_t bufferBytes = ldfBufferLength*4;
+
+	fileFollower follower(64*bufferBytes);
+	if(!follower.open(fname_, foffset_)){
+		std::cout << " ERROR: Failed to open input file \"" << fname_ << "\"!\n";
+		return false;
+	}
+
+	std::cout << " Following \"" << fname_ << "\" from byte " << foffset_ << " using " << (follower.usingInotify() ? "inotify" : "polling") << ". Press ctrl-c to stop.\n";
+	signal(SIGINT, follow_interrupt);
+
+	std::vector<unsigned int> words(ldfBufferLength+1);
+	wordSearch<unsigned int> headers(std::vector<unsigned int>(bufferTypes, bufferTypes+numBufferTypes));
+	unsigned long long buff_count = buffer_base;
+	int eof_count = 0;
+
+	while(follow_running && eof_count < 2){
+		follower.update();
+
+		// Decode every complete buffer in the ring.
+		while(true){
+			size_t nWords = follower.available()/4;
+			if(nWords == 0) break;
+			if(nWords > ldfBufferLength+1) nWords = ldfBufferLength+1;
+			follower.peek((char*)words.data(), nWords*4);
+			if(swap_bytes) byteSwap(words.data(), words.data(), nWords);
+
+			// Resynchronize on the next buffer header.
+			if(!isBufferHeader(words[0])){
+				size_t skip = headers.find(words.data(), words.data()+nWords)-words.data();
+				std::cout << " Skipped " << skip << " words at word " << follower.getOffset()/4 << " before the next buffer header\n";
+				follower.consume(skip*4);
+				continue;
+			}
+
+			// The length of a buffer is only known once the following word has been written. The
+			// last end of file buffer is not followed by anything.
+			if(nWords <= ldfBufferLength && !(nWords == ldfBufferLength && words[0] == ENDFILE)) break;
+
+			// Check the expected position of the next buffer first, since buffer type words may also
+			// appear in the payload. Buffers which are cut short are followed immediately by the next header.
+			size_t length = ldfBufferLength;
+			if(nWords > ldfBufferLength && !isBufferHeader(words[ldfBufferLength])){
+				length = headers.find(words.data()+1, words.data()+ldfBufferLength)-words.data();
+			}
+
+			size_t used = length;
+			while(used > 2 && words[used-1] == (unsigned int)ENDBUFF) used--;
+
+			std::cout << " Buffer no. " << ++buff_count << " \"" << bufferNames[getBufferTypeIndex(words[0])] << "\" at word " << follower.getOffset()/4;
+			std::cout << ": " << length << " words, " << used << " used";
+			if(length != ldfBufferLength) std::cout << " [delta=" << (long long)length-ldfBufferLength << "] (UNDERFLOW)";
+			std::cout << std::endl;
+
+			if(words[0] == ENDFILE) eof_count++;
+			else eof_count = 0;
+
+			follower.consume(length*4);
+		}
+
+		if(eof_count < 2 && follower.available() <= bufferBytes)
+			follower.wait(500);
+	}
+
+	signal(SIGINT, SIG_DFL);
+	std::cout << "\n Followed " << buff_count-buffer_base << " buffers up to word no. " << follower.getOffset()/4 << " in file.\n";
+
+	return true;
 }
 
 // Display a list of commonly used ldf buffer headers.
@@ -205,11 +1494,32 @@ int main(int argc, char *argv[]){
 	handler.add(optionExt("type", required_argument, NULL, 't', "<int>", "Only display buffers of a specified type"));
 	handler.add(optionExt("raw", no_argument, NULL, 'r', "", "Display raw buffer words (hidden by default)"));
 	handler.add(optionExt("convert", no_argument, NULL, 'c', "", "Attempt to convert words to Ascii characters"));
-	handler.add(optionExt("search", required_argument, NULL, 's', "<int>", "Search for an integer in the data stream"));
+	handler.add(optionExt("search", required_argument, NULL, 's', "<int[,int,...]>", "Search for one or more integers in the data stream"));
 	handler.add(optionExt("list", no_argument, NULL, 'l', "", "Display a list of commonly used ldf buffer headers"));
 	handler.add(optionExt("zero", no_argument, NULL, 'z', "", "Suppress zero output"));
 	handler.add(optionExt("word", required_argument, NULL, 'w', "<int>", "Specify the file word size"));
 	handler.add(optionExt("offset", required_argument, NULL, 'o', "<long long>", "Specify the start word of the file"));
+	handler.add(optionExt("context", required_argument, NULL, 'C', "<[before:]after>", "Number of context words to display around search matches (default=0:4)"));
+	handler.add(optionExt("summary", no_argument, NULL, 'S', "", "Count buffers of each type and report anomalous buffer lengths"));
+	handler.add(optionExt("threads", required_argument, NULL, 'j', "<int>", "Number of threads to use for parallel modes (default=all cores)"));
+	handler.add(optionExt("index", no_argument, NULL, 'x', "", "Build (or load) the sidecar buffer index of the input file"));
+	handler.add(optionExt("buffer", required_argument, NULL, 'b', "<int>", "Start at buffer number N, counting from 1 (or the Nth buffer of the type given by --type) using the buffer index"));
+	handler.add(optionExt("follow", no_argument, NULL, 'F', "", "Follow a file which is still being written and summarize new buffers as they arrive"));
+	handler.add(optionExt("pattern", required_argument, NULL, 'p', "<int[/mask],...>", "Search for a sequence of words, each compared under an optional bit mask (use * as a wildcard)"));
+	handler.add(optionExt("count", no_argument, NULL, 'n', "", "Only count search matches"));
+	handler.add(optionExt("diff", required_argument, NULL, 'D', "<filename>", "Compare the input file against another file buffer by buffer"));
+	handler.add(optionExt("view", no_argument, NULL, 'v', "", "Browse the input file with an interactive full screen viewer"));
+	handler.add(optionExt("decode", no_argument, NULL, 'd', "", "Decode Pixie16 channel headers in DATA buffers and count events per channel (use with --raw to display each header)"));
+	handler.add(optionExt("swap", no_argument, NULL, 'e', "", "Reverse the byte order of each word (for files written on big-endian systems, not supported by --view, --index or --buffer)"));
+	handler.add(optionExt("extract", required_argument, NULL, 'X', "<filename>", "Copy all buffers of the type given by --type (or of any type) to a new file"));
+	handler.add(optionExt("range", required_argument, NULL, 'R', "<first[:last]>", "Only extract buffers with numbers in the range [first, last]"));
+	handler.add(optionExt("histogram", required_argument, NULL, 'H', "<mask>", "Histogram the values of a bit field of each word (use 0 for the whole word), only in buffers of --type if given"));
+	handler.add(optionExt("triage", no_argument, NULL, 'T', "", "Compute per-buffer zero fraction, byte entropy and padding statistics and flag outliers"));
+	handler.add(optionExt("limit", required_argument, NULL, 'L', "<long long>", "Stop after reading a number of words (following --offset)"));
+	handler.add(optionExt("sample", required_argument, NULL, 'N', "<int>", "Only read and display every Nth buffer"));
+	handler.add(optionExt("timeline", required_argument, NULL, 'm', "<seconds>", "Print buffer, word and event rates in time bins of the given width using channel timestamps"));
+	handler.add(optionExt("tick", required_argument, NULL, 'k', "<ns>", "Length of a channel timestamp tick for --timeline (default=8)"));
+	handler.add(optionExt("force", no_argument, NULL, 'f', "", "Overwrite an existing output file of --extract"));
 
 	if(!handler.setup(argc, argv)){
 		return 1;
@@ -231,7 +1541,7 @@ int main(int argc, char *argv[]){
 	}
 	
 	int word_size = 4;
-	std::streampos foffset = 0;
+	unsigned long long foffset = 0;
 	
 	if(handler.getOption(1)->active){
 		buffer_select = strtoul(handler.getOption(1)->argument.c_str(), NULL, 0);
@@ -245,8 +1555,46 @@ int main(int argc, char *argv[]){
 	}
 	if(handler.getOption(4)->active){
 		do_search = true; 
-		search_int = strtoul(handler.getOption(4)->argument.c_str(), NULL, 0);
-		std::cout << " Searching for " << search_int << " (" << convert_to_hex(search_int) << ")\n";
+		std::stringstream stream(handler.getOption(4)->argument);
+		std::string value;
+		while(std::getline(stream, value, ',')){
+			unsigned long long search_val = strtoull(value.c_str(), NULL, 0);
+			if(search_list.size() >= wordSearch<unsigned int>::maxNeedles){
+				std::cout << " Error: Cannot search for more than " << wordSearch<unsigned int>::maxNeedles << " values at once!\n";
+				return 1;
+			}
+			search_list.push_back(search_val);
+			if(search_val <= 0xFFFFFFFF){ std::cout << " Searching for " << search_val << " (" << convert_to_hex((unsigned int)search_val) << ")\n"; }
+			else{ std::cout << " Searching for " << search_val << " (" << convert_to_hex(search_val) << ")\n"; }
+		}
+	}
+	if(handler.getOption(15)->active){
+		do_search = true;
+		std::stringstream stream(handler.getOption(15)->argument);
+		std::string value;
+		std::cout << " Searching for sequence:";
+		while(std::getline(stream, value, ',')){
+			unsigned long long search_val = 0;
+			unsigned long long search_mask = 0;
+			if(value != "*"){
+				size_t index = value.find('/');
+				search_val = strtoull(value.substr(0, index).c_str(), NULL, 0);
+				search_mask = (index != std::string::npos ? strtoull(value.substr(index+1).c_str(), NULL, 0) : (unsigned long long)(-1));
+			}
+			search_pattern.push_back(std::make_pair(search_val, search_mask));
+			if(search_mask == 0){ std::cout << " *"; }
+			else if(search_mask == (unsigned long long)(-1)){ std::cout << " " << search_val; }
+			else if(search_mask <= 0xFFFFFFFF){ std::cout << " " << search_val << "/" << convert_to_hex((unsigned int)search_mask); }
+			else{ std::cout << " " << search_val << "/" << convert_to_hex(search_mask); }
+		}
+		std::cout << std::endl;
+	}
+	if(handler.getOption(16)->active){
+		count_only = true;
+	}
+	if(handler.getOption(20)->active){
+		swap_bytes = true;
+		std::cout << " Reversing the byte order of each word (" << byteSwapInstructionSet() << ")\n";
 	}
 	if(handler.getOption(6)->active){
 		show_zero = false;
@@ -263,25 +1611,169 @@ int main(int argc, char *argv[]){
 		foffset = strtoll(handler.getOption(8)->argument.c_str(), NULL, 0);
 		std::cout << " Starting at word no. " << foffset << " in file.\n";
 	}
+	if(handler.getOption(9)->active){
+		std::string arg = handler.getOption(9)->argument;
+		size_t index = arg.find(':');
+		if(index != std::string::npos){
+			context_before = strtoul(arg.substr(0, index).c_str(), NULL, 0);
+			context_after = strtoul(arg.substr(index+1).c_str(), NULL, 0);
+		}
+		else{ context_after = strtoul(arg.c_str(), NULL, 0); }
+	}
+	if(handler.getOption(25)->active){
+		word_limit = strtoull(handler.getOption(25)->argument.c_str(), NULL, 0);
+		std::cout << " Reading at most " << word_limit << " words.\n";
+	}
+	num_threads = std::thread::hardware_concurrency();
+	if(handler.getOption(11)->active){
+		num_threads = strtoul(handler.getOption(11)->argument.c_str(), NULL, 0);
+	}
+	if(num_threads == 0) num_threads = 1;
 	
-	std::ifstream input(ifname.c_str(), std::ios::binary);
-	if(!input.good()){
+	mappedFile input;
+	if(!input.open(ifname)){
 		std::cout << " ERROR: Failed to open input file \"" << ifname << "\"!\n";
 		return 1;
 	}
 
-	input.seekg(foffset*word_size);
+	// The buffer index and the interactive viewer read the file in its own byte order.
+	if(swap_bytes && (handler.getOption(12)->active || handler.getOption(13)->active || handler.getOption(18)->active)){
+		std::cout << " ERROR: Byte order swapping is not supported with --index, --buffer or --view!\n";
+		return 1;
+	}
 
-	unsigned int good_buff_count = 0;
-	unsigned int total_count = 0;
-	unsigned int buff_count = 0;
+	// Use the sidecar buffer index to seek directly to the requested buffer.
+	if(handler.getOption(12)->active || handler.getOption(13)->active){
+		bufferIndex index;
+		if(!index.load(ifname, input, num_threads)){
+			std::cout << " ERROR: Failed to index input file \"" << ifname << "\"! A regular file is required.\n";
+			return 1;
+		}
+		std::cout << " Loaded buffer index with " << index.size() << " buffers\n";
 
-	if(word_size == 1){ go<unsigned char>(&input, buff_count, good_buff_count, total_count); }
-	else if(word_size == 2){ go<unsigned short>(&input, buff_count, good_buff_count, total_count); }
-	else if(word_size == 4){ go<unsigned int>(&input, buff_count, good_buff_count, total_count); }
-	else{ go<unsigned long long>(&input, buff_count, good_buff_count, total_count); }
+		if(handler.getOption(13)->active){
+			unsigned long long buffer_number = strtoull(handler.getOption(13)->argument.c_str(), NULL, 0);
+			long long position = (buffer_number > 0 ? index.find(buffer_number-1, buffer_select) : -1);
+			if(position >= 0 && !index.verify(input, position)){ // The sidecar does not describe this file.
+				std::cout << " WARNING: Buffer index does not match the input file! Rebuilding.\n";
+				if(!index.load(ifname, input, num_threads, true)){
+					std::cout << " ERROR: Failed to index input file \"" << ifname << "\"!\n";
+					return 1;
+				}
+				position = index.find(buffer_number-1, buffer_select);
+			}
+			if(position < 0){
+				std::cout << " ERROR: Buffer no. " << buffer_number << " does not exist!\n";
+				return 1;
+			}
+			foffset = index.at(position).offset/word_size;
+			buffer_base = position;
+			std::cout << " Starting at buffer no. " << position+1;
+			if(buffer_select != 0) std::cout << " (\"" << bufferNames[getBufferTypeIndex(buffer_select)] << "\" buffer no. " << buffer_number << ")";
+			std::cout << " at word no. " << foffset << " in file.\n";
+		}
+		else if(!handler.getOption(10)->active && !do_search && !show_raw){
+			return 0; // Only build the index.
+		}
+	}
+
+	unsigned long long good_buff_count = 0;
+	unsigned long long total_count = 0;
+	unsigned long long buff_count = 0;
+
+	if(handler.getOption(14)->active){
+		// Start at the last buffer boundary, unless the user asked for a specific place.
+		unsigned long long byteOffset = foffset*word_size;
+		if(!handler.getOption(8)->active && !handler.getOption(13)->active && input.isMapped())
+			byteOffset = (input.getSize()/(ldfBufferLength*4))*ldfBufferLength*4;
+		input.close();
+		return (follow(ifname, byteOffset) ? 0 : 1);
+	}
+
+	bool retval;
+	if(handler.getOption(21)->active){
+		unsigned long long first = 1;
+		unsigned long long last = (unsigned long long)(-1);
+		if(handler.getOption(22)->active){
+			std::string arg = handler.getOption(22)->argument;
+			size_t index = arg.find(':');
+			first = strtoull(arg.substr(0, index).c_str(), NULL, 0);
+			if(index != std::string::npos) last = strtoull(arg.substr(index+1).c_str(), NULL, 0);
+		}
+		retval = extract(input, handler.getOption(21)->argument, first, last, handler.getOption(29)->active);
+		input.close();
+		return (retval ? 0 : 1);
+	}
+	else if(handler.getOption(23)->active){
+		unsigned long long mask = strtoull(handler.getOption(23)->argument.c_str(), NULL, 0);
+		if(word_size == 1){ retval = histogram<unsigned char>(input, foffset, mask); }
+		else if(word_size == 2){ retval = histogram<unsigned short>(input, foffset, mask); }
+		else if(word_size == 4){ retval = histogram<unsigned int>(input, foffset, mask); }
+		else{ retval = histogram<unsigned long long>(input, foffset, mask); }
+		input.close();
+		return (retval ? 0 : 1);
+	}
+	else if(handler.getOption(27)->active){
+		double tick = 8.0;
+		if(handler.getOption(28)->active) tick = strtod(handler.getOption(28)->argument.c_str(), NULL);
+		retval = timeline(input, strtod(handler.getOption(27)->argument.c_str(), NULL), tick);
+		input.close();
+		return (retval ? 0 : 1);
+	}
+	else if(handler.getOption(24)->active){
+		retval = triage(input, foffset*word_size);
+		input.close();
+		return (retval ? 0 : 1);
+	}
+	else if(handler.getOption(17)->active){
+		retval = diff(input, handler.getOption(17)->argument);
+		input.close();
+		return (retval ? 0 : 1);
+	}
+	else if(handler.getOption(18)->active){
+		if(!input.isMapped()){
+			std::cout << " ERROR: The interactive viewer requires a regular (seekable) input file!\n";
+			return 1;
+		}
+		hexPager pager(input, convert);
+		pager.setBufferType(buffer_select);
+		retval = pager.run(foffset*word_size/4);
+		input.close();
+		return (retval ? 0 : 1);
+	}
+	else if(handler.getOption(19)->active){
+		retval = decode(input);
+		input.close();
+		return (retval ? 0 : 1);
+	}
+	else if(handler.getOption(10)->active){
+		retval = census(input, foffset*word_size);
+		input.close();
+		return (retval ? 0 : 1);
+	}
+	else if(do_search){
+		if(word_size == 1){ retval = search<unsigned char>(input, foffset*word_size, total_count); }
+		else if(word_size == 2){ retval = search<unsigned short>(input, foffset*word_size, total_count); }
+		else if(word_size == 4){ retval = search<unsigned int>(input, foffset*word_size, total_count); }
+		else{ retval = search<unsigned long long>(input, foffset*word_size, total_count); }
+	}
+	else if(handler.getOption(26)->active){
+		unsigned long long stride = strtoull(handler.getOption(26)->argument.c_str(), NULL, 0);
+		if(stride == 0) stride = 1;
+		std::cout << " Sampling every " << stride << " buffers\n";
+		if(word_size == 1){ retval = sample<unsigned char>(input, foffset*word_size, stride, buff_count, good_buff_count, total_count); }
+		else if(word_size == 2){ retval = sample<unsigned short>(input, foffset*word_size, stride, buff_count, good_buff_count, total_count); }
+		else if(word_size == 4){ retval = sample<unsigned int>(input, foffset*word_size, stride, buff_count, good_buff_count, total_count); }
+		else{ retval = sample<unsigned long long>(input, foffset*word_size, stride, buff_count, good_buff_count, total_count); }
+	}
+	else if(word_size == 1){ retval = scan<unsigned char>(input, foffset*word_size, buff_count, good_buff_count, total_count); }
+	else if(word_size == 2){ retval = scan<unsigned short>(input, foffset*word_size, buff_count, good_buff_count, total_count); }
+	else if(word_size == 4){ retval = scan<unsigned int>(input, foffset*word_size, buff_count, good_buff_count, total_count); }
+	else{ retval = scan<unsigned long long>(input, foffset*word_size, buff_count, good_buff_count, total_count); }
 
 	input.close();
+
+	if(!retval) return 1;
 	
 	if(!do_search){
 		std::cout << "\n\n Read " << total_count << " " << word_size << " byte words (";
@@ -12,41 +12,574 @@
 #include <iostream>
 #include <fstream>
 #include <vector>
+#include <set>
+#include <unordered_map>
+#include <thread>
+#include <string.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
 
 #include "optionHandler.hpp"
 
-#define HEAD 1145128264 // Run begin buffer
-#define DATA 1096040772 // Physics data buffer
-#define SCAL 1279345491 // Scaler type buffer
-#define DEAD 1145128260 // Deadtime buffer
-#define DIR 542263620   // "DIR "
-#define PAC 541278544   // "PAC "
-#define ENDFILE 541478725 // End of file buffer
+#include "blockIO.hpp"
+#include "bufferScan.hpp"
+#include "mappedFile.hpp"
+#include "fileCopy.hpp"
+#include "spillScan.hpp"
+#include "wordHash.hpp"
+#include "repairCheckpoint.hpp"
 
 const unsigned int delimiter = -1;
 
 const int buffLength = 8194;
 const int buffLengthB = 32776;
 
-class buffer{
+const size_t maxRepairLength = 4194304; ///< Overfilled buffers longer than this many words are copied unchanged.
+
+/// Compact map of the buffers of a file, stored as runs of consecutive valid buffers plus a list of anomalous buffers.
+class bufferMap{
   public:
-	std::streampos startpos;
-	int length;
-	bool valid;
-	
-	buffer() : startpos(0), length(0), valid(false) { }
-	
-	buffer(const std::streampos &start_, const int &length_) : startpos(start_), length(length_) { 
-		if(length == buffLength) valid = true;
-		else valid = false;
+	/// A run of consecutive valid buffers.
+	struct run{
+		unsigned long long offset; ///< Word offset of the first buffer of the run.
+		unsigned long long numBuffers; ///< The number of buffers in the run.
+
+		run(const unsigned long long &offset_, const unsigned long long &numBuffers_) : offset(offset_), numBuffers(numBuffers_) { }
+
+		/// Return the word offset of the end of the run.
+		unsigned long long end() const { return offset+numBuffers*buffLength; }
+	};
+
+	std::vector<run> runs; ///< Runs of valid buffers in file order.
+	std::vector<bufferInfo> anomalies; ///< Buffers of the wrong length in file order.
+
+	/// Add a buffer which follows all buffers already in the map.
+	void add(const bufferInfo &buff_){
+		if(!buff_.valid()) anomalies.push_back(buff_);
+		else if(!runs.empty() && runs.back().end() == buff_.offset) runs.back().numBuffers++;
+		else runs.push_back(run(buff_.offset, 1));
+	}
+
+	/// Append a map of buffers which follow all buffers already in the map.
+	void append(const bufferMap &other_){
+		std::vector<run>::const_iterator iter = other_.runs.begin();
+		if(iter != other_.runs.end() && !runs.empty() && runs.back().end() == iter->offset){
+			runs.back().numBuffers += iter->numBuffers;
+			++iter;
+		}
+		runs.insert(runs.end(), iter, other_.runs.end());
+		anomalies.insert(anomalies.end(), other_.anomalies.begin(), other_.anomalies.end());
+	}
+
+	/// Return the total number of buffers in the map.
+	unsigned long long getNumBuffers() const {
+		unsigned long long total = anomalies.size();
+		for(std::vector<run>::const_iterator iter = runs.begin(); iter != runs.end(); ++iter)
+			total += iter->numBuffers;
+		return total;
+	}
+
+	/** Visit all runs and anomalous buffers in file order. Calls runFunc_(run) for each
+	  * run of valid buffers and anomalyFunc_(buffer) for each anomalous buffer.
+	  * \return Nothing.
+	  */
+	template <typename F, typename G>
+	void forEach(F runFunc_, G anomalyFunc_) const {
+		std::vector<run>::const_iterator iter = runs.begin();
+		std::vector<bufferInfo>::const_iterator anomaly = anomalies.begin();
+		while(iter != runs.end() || anomaly != anomalies.end()){
+			if(anomaly == anomalies.end() || (iter != runs.end() && iter->offset < anomaly->offset)) runFunc_(*iter++);
+			else anomalyFunc_(*anomaly++);
+		}
 	}
 };
 
 bool validBuffer(const unsigned int &head_){
-	if(head_==HEAD || head_==DATA || head_==SCAL || head_==DEAD || head_==DIR || head_==PAC || head_==ENDFILE)
-		return true;
-		
-	return false;
+	return isBufferHeader(head_);
+}
+
+/** Write a block of words to a file, retrying after partial writes.
+  * \param[in]  fd_     Descriptor of the output file.
+  * \param[in]  words_  Pointer to the words to write.
+  * \param[in]  nWords_ The number of words to write.
+  * \return True upon success and false if a write error occurred.
+  */
+bool writeWords(const int &fd_, const unsigned int *words_, const size_t &nWords_){
+	const char *data = (const char*)words_;
+	size_t remaining = nWords_*4;
+	while(remaining > 0){
+		ssize_t retval = write(fd_, data, remaining);
+		if(retval < 0 && errno == EINTR) continue;
+		if(retval <= 0) return false;
+		data += retval;
+		remaining -= retval;
+	}
+	return true;
+}
+
+/** Split an overfilled buffer into buffers of the correct length. The chunks of DATA buffers
+  * are repacked so that no chunk straddles two buffers, and any padding between them (e.g. from
+  * a buffer whose header was lost) is removed. Any remaining words
+  * (and the contents of all other buffer types) are split at arbitrary positions, and trailing
+  * delimiters are dropped. Each follow-on buffer begins with a copy of the two word header of
+  * the original buffer and every buffer is padded with delimiters.
+  * \param[in]  words_   Pointer to the start of the overfilled buffer.
+  * \param[in]  length_  The length of the overfilled buffer in words (at least two).
+  * \param[out] output_  Vector to which the repaired buffers are appended.
+  * \return The number of buffers appended to the output.
+  */
+size_t splitBuffer(const unsigned int *words_, const size_t &length_, std::vector<unsigned int> &output_){
+	const size_t payload = buffLength-2;
+	size_t nBuffers = 0;
+	size_t used = 0; // Number of payload words used in the current buffer.
+
+	// Pad the current buffer and start a new one.
+	auto newBuffer = [&](){
+		if(nBuffers > 0) output_.insert(output_.end(), payload-used, delimiter);
+		output_.push_back(words_[0]);
+		output_.push_back(words_[1]);
+		used = 0;
+		nBuffers++;
+	};
+	newBuffer();
+
+	size_t pos = 2;
+	if(words_[0] == DATA){ // Copy whole chunks.
+		while(pos+3 <= length_){
+			if(words_[pos] == delimiter){ // Skip padding between chunks.
+				pos++;
+				continue;
+			}
+			const size_t chunkSize = words_[pos]/4;
+			if(words_[pos] % 4 != 0 || chunkSize < 3 || chunkSize > payload || pos+chunkSize > length_) break;
+			if(used+chunkSize > payload) newBuffer();
+			output_.insert(output_.end(), words_+pos, words_+pos+chunkSize);
+			used += chunkSize;
+			pos += chunkSize;
+		}
+	}
+
+	// Copy any remaining words, excluding trailing delimiters.
+	size_t stop = length_;
+	while(stop > pos && words_[stop-1] == delimiter) stop--;
+	while(pos < stop){
+		if(used == payload) newBuffer();
+		size_t nCopy = (stop-pos < payload-used ? stop-pos : payload-used);
+		output_.insert(output_.end(), words_+pos, words_+pos+nCopy);
+		used += nCopy;
+		pos += nCopy;
+	}
+
+	output_.insert(output_.end(), payload-used, delimiter);
+
+	return nBuffers;
+}
+
+/** Locate every buffer in a span of words using multiple threads. Each thread walks one chunk
+  * of the span (see bufferScan) and builds a map of its chunk. The maps of all chunks are stitched
+  * together in file order. Any words preceding the first buffer header are reported as a single
+  * (invalid) buffer. Since the map decides which words are rewritten, the chunks are checked to
+  * meet exactly at buffer boundaries, and the span is scanned again using a single thread if not.
+  * \param[in]  words_    Pointer to the start of the span.
+  * \param[in]  nWords_   The number of words in the span.
+  * \param[in]  nThreads_ The number of threads to use.
+  * \param[out] map_      The map of the buffers found in the span.
+  * \return The number of chunks which were scanned.
+  */
+size_t scanBuffers(const unsigned int *words_, const size_t &nWords_, const unsigned int &nThreads_, bufferMap &map_){
+	map_ = bufferMap();
+	if(nWords_ == 0) return 0;
+
+	bufferScan scanner(words_, nWords_);
+	std::vector<bufferMap> chunks(nThreads_ > 0 ? nThreads_ : 1);
+	std::vector<size_t> lastBuffers(chunks.size(), 0);
+	size_t nChunks = scanner.walkParallel(nThreads_, [&](const size_t &chunk_, const bufferInfo &buff_){
+		chunks[chunk_].add(buff_);
+		lastBuffers[chunk_] = buff_.offset;
+	});
+
+	// Check that the buffer following the last buffer of each chunk (found without stopping
+	// at the end of the chunk) is the first buffer of the next chunk.
+	for(size_t i = 0; i+1 < nChunks; i++){
+		const size_t next = scanner.next(lastBuffers[i], nWords_);
+		if(next != scanner.getChunkEnd(i)){
+			std::cout << " WARNING: Buffer at position " << lastBuffers[i] << " ends at word " << next << " instead of chunk boundary " << scanner.getChunkEnd(i) << ", scanning again using 1 thread.\n";
+			return scanBuffers(words_, nWords_, 1, map_);
+		}
+	}
+
+	// Stitch the chunks together.
+	if(scanner.getFirstBuffer() > 0)
+		map_.add(bufferInfo(0, words_[0], scanner.getFirstBuffer()));
+	for(size_t i = 0; i < nChunks; i++)
+		map_.append(chunks[i]);
+
+	return nChunks;
+}
+
+/// A framing error found while validating DATA buffers.
+struct spillError{
+	unsigned long long offset; ///< Word offset of the offending chunk header (or of the buffer completing a spill with bad module records).
+	long long spill; ///< Index of the damaged spill (-1 for chunks preceding the first spill).
+	const char *reason; ///< Description of the error.
+
+	spillError(const unsigned long long &offset_, const long long &spill_, const char *reason_) : offset(offset_), spill(spill_), reason(reason_) { }
+};
+
+/** Check the chunk headers, chunk counts, spill continuity and module records of every DATA buffer
+  * using multiple threads (see spillScan), and report each damaged spill.
+  * \param[in]  words_    Pointer to the start of the file.
+  * \param[in]  nWords_   The number of words in the file.
+  * \param[in]  nThreads_ The number of threads to use.
+  * \return The number of framing errors found.
+  */
+unsigned long long validate(const unsigned int *words_, const size_t &nWords_, const unsigned int &nThreads_){
+	spillScan reader(words_, nWords_);
+	std::vector<std::vector<spillError> > errors(2*(nThreads_ > 0 ? nThreads_ : 1));
+	size_t nChunks = reader.read(nThreads_, [](const size_t &, const bufferInfo &){ },
+	[&](const size_t &slot_, const long long &spill_, const unsigned long long &offset_, const spillStart &, const std::vector<unsigned int> &data_){
+		if(!spillReader::forEachModule(data_, [](const unsigned int &, const unsigned int *, const size_t &){ }))
+			errors[slot_].push_back(spillError(offset_, spill_, "BAD MODULE RECORDS"));
+	}, [&](const size_t &slot_, const long long &spill_, const unsigned long long &offset_, const spillReader::STATUS &status_){
+		errors[slot_].push_back(spillError(offset_, spill_, spillReader::getStatusName(status_)));
+	});
+
+	// Report the errors in file order.
+	unsigned long long numErrors = 0;
+	std::set<long long> damaged;
+	std::cout << " Validating DATA buffers of " << nWords_ << " words using " << nChunks << " threads\n";
+	for(size_t slot = 0; slot < reader.getNumSlots(); slot++){
+		for(std::vector<spillError>::const_iterator iter = errors[slot].begin(); iter != errors[slot].end(); ++iter){
+			long long spill = reader.getSpillIndex(slot, iter->spill);
+			if(spill < 0) std::cout << "  Chunk before the first spill";
+			else std::cout << "  Spill no. " << spill+1;
+			std::cout << " at word " << iter->offset << ": " << iter->reason << std::endl;
+			damaged.insert(spill);
+			numErrors++;
+		}
+	}
+
+	if(numErrors == 0) std::cout << " Found no framing errors in " << reader.getNumSpills() << " spills :-)\n";
+	else std::cout << "\n Found " << numErrors << " framing errors in " << damaged.size() << " damaged spills of " << reader.getNumSpills() << " total.\n";
+
+	return numErrors;
+}
+
+/// Hash of the contents of a single buffer or spill.
+struct hashEntry{
+	unsigned long long hash; ///< 64-bit hash of the contents.
+	unsigned long long offset; ///< Word offset of the buffer (or of the buffer which completed the spill).
+	unsigned long long length; ///< Length of the buffer (or of the spill data) in words.
+	long long spill; ///< Index of the spill (spills only).
+	spillStart start; ///< Location of the first chunk of the spill (spills only).
+
+	hashEntry(const unsigned long long &hash_, const unsigned long long &offset_, const unsigned long long &length_, const long long &spill_, const spillStart &start_=spillStart()) : hash(hash_), offset(offset_), length(length_), spill(spill_), start(start_) { }
+};
+
+/** Find buffers and spills which are exact duplicates of an earlier buffer or spill. Every buffer and
+  * every reassembled spill is hashed using multiple threads, and duplicates are found in file order
+  * using a hash table. Duplicate buffers and spills are confirmed by comparing their contents. End of
+  * file buffers and buffers containing only padding are ignored. If an output filename is given, a copy
+  * of the file without the duplicate buffers is written.
+  * \param[in]  words_    Pointer to the start of the file.
+  * \param[in]  nBytes_   The length of the file in bytes.
+  * \param[in]  nThreads_ The number of threads to use.
+  * \param[in]  fdIn_     Descriptor of the input file.
+  * \param[in]  fdOut_    Descriptor of the output file, or -1 if no output is written.
+  * \return True upon success and false if the output could not be written.
+  */
+bool deduplicate(const unsigned int *words_, const unsigned long long &nBytes_, const unsigned int &nThreads_, const int &fdIn_, const int &fdOut_){
+	const size_t nWords = nBytes_/4;
+	const size_t nSlots = (nThreads_ > 0 ? nThreads_ : 1);
+	std::vector<std::vector<hashEntry> > buffers(nSlots);
+	std::vector<std::vector<hashEntry> > spills(2*nSlots);
+
+	spillScan reader(words_, nWords);
+	size_t nChunks = reader.read(nThreads_, [&](const size_t &chunk_, const bufferInfo &buff_){
+		const unsigned int *buff = words_+buff_.offset;
+		if(buff_.type == ENDFILE) return;
+		size_t pos = 2;
+		while(pos < buff_.length && buff[pos] == delimiter) pos++;
+		if(pos == buff_.length) return; // Empty buffer.
+		buffers[chunk_].push_back(hashEntry(hashWords(buff, buff_.length), buff_.offset, buff_.length, 0));
+	}, [&](const size_t &slot_, const long long &spill_, const unsigned long long &offset_, const spillStart &start_, const std::vector<unsigned int> &data_){
+		spills[slot_].push_back(hashEntry(hashWords(data_.data(), data_.size()), offset_, data_.size(), spill_, start_));
+	}, [](const size_t &, const long long &, const unsigned long long &, const spillReader::STATUS &){ });
+
+	std::cout << " Hashed " << nWords << " words using " << nChunks << " threads\n";
+
+	// Find duplicate buffers in file order.
+	std::unordered_map<unsigned long long, std::pair<unsigned long long, const hashEntry*> > seen;
+	std::vector<const hashEntry*> duplicates;
+	unsigned long long numBuffers = 0;
+	for(size_t i = 0; i < nChunks; i++){
+		for(std::vector<hashEntry>::const_iterator iter = buffers[i].begin(); iter != buffers[i].end(); ++iter){
+			numBuffers++;
+			std::pair<unsigned long long, const hashEntry*> &first = seen[iter->hash];
+			if(first.second == NULL){
+				first = std::make_pair(numBuffers, &(*iter));
+				continue;
+			}
+			const hashEntry *original = first.second;
+			if(original->length != iter->length || memcmp(words_+original->offset, words_+iter->offset, iter->length*4) != 0) continue; // Hash collision.
+			if(duplicates.empty()) std::cout << "\n Duplicate buffers:\n";
+			std::cout << "  Buffer no. " << numBuffers << " \"" << bufferNames[getBufferTypeIndex(words_[iter->offset])] << "\" at word " << iter->offset;
+			std::cout << " duplicates buffer no. " << first.first << " at word " << original->offset << std::endl;
+			duplicates.push_back(&(*iter));
+		}
+	}
+
+	// Find duplicate spills in file order.
+	seen.clear();
+	unsigned long long numDuplicateSpills = 0;
+	std::vector<unsigned int> originalData, duplicateData;
+	for(size_t slot = 0; slot < reader.getNumSlots(); slot++){
+		for(std::vector<hashEntry>::const_iterator iter = spills[slot].begin(); iter != spills[slot].end(); ++iter){
+			const long long spill = reader.getSpillIndex(slot, iter->spill);
+			std::pair<unsigned long long, const hashEntry*> &first = seen[iter->hash];
+			if(first.second == NULL){
+				first = std::make_pair(spill, &(*iter));
+				continue;
+			}
+			const hashEntry *original = first.second;
+			if(original->length != iter->length) continue; // Hash collision.
+			if(!reader.readSpill(original->start, originalData) || !reader.readSpill(iter->start, duplicateData) ||
+			   originalData.size() != duplicateData.size() || memcmp(originalData.data(), duplicateData.data(), duplicateData.size()*4) != 0) continue;
+			if(numDuplicateSpills++ == 0) std::cout << "\n Duplicate spills:\n";
+			std::cout << "  Spill no. " << spill+1 << " ending at word " << iter->offset << " duplicates spill no. " << first.first+1 << " ending at word " << first.second->offset << std::endl;
+		}
+	}
+
+	std::cout << "\n Found " << duplicates.size() << " duplicate buffers of " << numBuffers << " and " << numDuplicateSpills << " duplicate spills of " << reader.getNumSpills() << ".\n";
+	if(fdOut_ < 0) return true;
+
+	// Copy everything except the duplicate buffers.
+	unsigned long long start = 0;
+	for(std::vector<const hashEntry*>::iterator iter = duplicates.begin(); iter != duplicates.end(); ++iter){
+		if(!copyFileRange(fdIn_, start*4, fdOut_, ((*iter)->offset-start)*4)) return false;
+		start = (*iter)->offset+(*iter)->length;
+	}
+	if(!copyFileRange(fdIn_, start*4, fdOut_, nBytes_-start*4)) return false;
+
+	unsigned long long fileLength = lseek(fdOut_, 0, SEEK_CUR);
+	std::cout << " Removed " << duplicates.size() << " duplicate buffers. Output file length is " << fileLength << " B (" << fileLength/4 << " words, " << fileLength/buffLengthB << " ldf buffers)\n";
+
+	return true;
+}
+
+/** Repair a file in a single streaming pass. The input is read in large blocks by a background
+  * thread while the previous block is processed, and the output is written the same way, so the
+  * file is read and written exactly once. A buffer is valid if the word which follows it is a
+  * buffer header. Otherwise it ends at the first buffer header following its start, and is padded
+  * with delimiters if it is too short or split into several buffers if it is too long.
+  * The repair starts from the input and output offsets of the state, and if the state has a
+  * checkpoint interval, the state is saved to a checkpoint file at buffer boundaries.
+  * \param[in]  fdIn_       Descriptor of the input file.
+  * \param[in]  fdOut_      Descriptor of the output file, positioned at the output offset of the state.
+  * \param[in]  debug_      Print the position of every valid buffer.
+  * \param[in]  state_      The state of the repair, which is updated as the repair progresses.
+  * \param[in]  checkpoint_ Path to the checkpoint file.
+  * \return True upon success and false if a read or write error occurred.
+  */
+bool streamRepair(const int &fdIn_, const int &fdOut_, const bool &debug_, repairCheckpoint &state_, const std::string &checkpoint_){
+	blockReader reader;
+	blockWriter writer;
+	reader.start(fdIn_, state_.inputOffset);
+	writer.start(fdOut_);
+
+	const std::vector<unsigned int> padding(buffLength, delimiter);
+
+	// Vectorized search for all known buffer types.
+	wordSearch<unsigned int> headers(std::vector<unsigned int>(bufferTypes, bufferTypes+numBufferTypes));
+
+	std::vector<unsigned int> window; // Words which have not been written yet.
+	size_t head = 0; // Index of the first unprocessed word in the window.
+	unsigned long long position = state_.inputOffset/4; // Word offset of window[head] in the input file.
+	unsigned long long bufferStart = position; // Word offset of the start of the current buffer.
+	unsigned int bufferType = 0; // Type word of the current buffer.
+	unsigned long long overflowLength = 0; // Words of an unrepairable overfilled buffer which were already written.
+
+	char partial[4]; // Trailing bytes which do not form a complete word.
+	size_t nPartial = 0;
+
+	const unsigned long long outputStart = state_.outputOffset;
+	unsigned long long lastCheckpoint = state_.inputOffset;
+	bool retval = true;
+
+	// Write words from the head of the window.
+	auto emit = [&](const size_t &nWords_){
+		if(!writer.write((const char*)(window.data()+head), nWords_*4)) retval = false;
+		head += nWords_;
+		position += nWords_;
+	};
+
+	// Report an invalid buffer.
+	auto report = [&](const unsigned long long &length_){
+		std::cout << " " << state_.numBadBuffers+1 << ") INVALID BUFFER no. " << state_.numBuffers+1 << " at position " << bufferStart << " in file. Buffer contains " << length_ << " words [delta=" << (long long)length_-buffLength << "] ";
+		std::cout << (length_ < (unsigned long long)buffLength ? "(UNDERFLOW)\n" : "(OVERFLOW)\n");
+		state_.anomalies.push_back(bufferInfo(bufferStart, bufferType, length_));
+		state_.numBuffers++;
+		state_.numBadBuffers++;
+	};
+
+	// Repair an invalid buffer at the head of the window.
+	std::vector<unsigned int> repaired;
+	auto repair = [&](const size_t &length_){
+		report(length_);
+		if(length_ < (size_t)buffLength){ // Pad the buffer.
+			std::cout << " -Appending " << buffLength-length_ << " words to end of buffer\n";
+			emit(length_);
+			if(!writer.write((const char*)padding.data(), (buffLength-length_)*4)) retval = false;
+		}
+		else{ // Split the buffer.
+			repaired.clear();
+			size_t nBuffers = splitBuffer(window.data()+head, length_, repaired);
+			std::cout << " -Splitting buffer into " << nBuffers << " buffers\n";
+			if(!writer.write((const char*)repaired.data(), repaired.size()*4)) retval = false;
+			head += length_;
+			position += length_;
+		}
+		state_.numRepaired++;
+	};
+
+	auto process = [&](const bool &eof_){
+		while(head < window.size()){
+			const unsigned int *ptr = window.data()+head;
+			const size_t avail = window.size()-head;
+			if(overflowLength == 0){
+				bufferStart = position;
+				bufferType = ptr[0];
+			}
+
+			// Check the expected position of the next buffer.
+			if(overflowLength == 0 && avail > (size_t)buffLength && validBuffer(ptr[buffLength])){
+				if(debug_)
+					std::cout << "  DEBUG: Copying buffer at position " << position << " [start=0x" << std::hex << ptr[0] << ", stop=0x" << ptr[buffLength-2] << std::dec << "]\n";
+				emit(buffLength);
+				state_.numBuffers++;
+				continue;
+			}
+			if(overflowLength == 0 && avail <= (size_t)buffLength && !eof_) return; // Need more data.
+
+			// The buffer has the wrong length. Search for the next buffer header.
+			size_t next = headers.find(ptr+(overflowLength == 0 ? 1 : 0), ptr+avail)-ptr;
+
+			if(overflowLength > 0){ // Stretch which is too long to repair. Copy it until the next buffer header.
+				overflowLength += next;
+				emit(next);
+				if(next < avail || eof_){
+					report(overflowLength);
+					std::cout << " -WARNING: Buffer is too long to be repaired and was copied unchanged!\n";
+					overflowLength = 0;
+				}
+			}
+			else if(next < avail || eof_){
+				if(next == (size_t)buffLength){ // Final buffer of the file.
+					emit(next);
+					state_.numBuffers++;
+				}
+				else if(next <= maxRepairLength) repair(next);
+				else{
+					emit(next);
+					report(next);
+					std::cout << " -WARNING: Buffer is too long to be repaired and was copied unchanged!\n";
+				}
+			}
+			else if(avail <= maxRepairLength){ // Need more data to find the end of the overfilled buffer.
+				return;
+			}
+			else{
+				overflowLength = avail;
+				emit(avail);
+			}
+		}
+	};
+
+	const char *data;
+	size_t nBytes;
+	while((nBytes = reader.next(data)) > 0 && retval){
+		// Discard the words which were already written.
+		window.erase(window.begin(), window.begin()+head);
+		head = 0;
+
+		// Complete a word which was split between blocks.
+		size_t offset = 0;
+		if(nPartial > 0){
+			while(nPartial < 4 && offset < nBytes) partial[nPartial++] = data[offset++];
+			if(nPartial < 4) continue;
+			unsigned int word;
+			memcpy((char*)&word, partial, 4);
+			window.push_back(word);
+			nPartial = 0;
+		}
+
+		size_t nWords = (nBytes-offset)/4;
+		size_t oldSize = window.size();
+		window.resize(oldSize+nWords);
+		memcpy((char*)(window.data()+oldSize), data+offset, nWords*4);
+		offset += nWords*4;
+		while(offset < nBytes) partial[nPartial++] = data[offset++];
+
+		process(false);
+
+		// Save a checkpoint once all output up to the current buffer boundary is on disk.
+		if(state_.interval > 0 && overflowLength == 0 && retval && position*4-lastCheckpoint >= state_.interval){
+			if(!writer.flush() || fdatasync(fdOut_) != 0){
+				retval = false;
+				break;
+			}
+			state_.inputOffset = position*4;
+			if(!state_.setOutput(fdOut_, outputStart+writer.getTotal()) || !state_.write(checkpoint_))
+				std::cout << " WARNING: Failed to write checkpoint \"" << checkpoint_ << "\"!\n";
+			else if(debug_)
+				std::cout << "  DEBUG: Saved checkpoint at input byte " << state_.inputOffset << " (output byte " << state_.outputOffset << ")\n";
+			lastCheckpoint = state_.inputOffset;
+		}
+	}
+	if(retval) process(true);
+
+	// Copy any trailing bytes which do not form a complete word.
+	if(nPartial > 0 && !writer.write(partial, nPartial)) retval = false;
+
+	reader.stop();
+	if(!writer.stop()) retval = false;
+	state_.inputOffset = position*4+nPartial;
+	state_.outputOffset = outputStart+writer.getTotal();
+	if(reader.error()){
+		std::cout << " ERROR: Failed to read from input file!\n";
+		return false;
+	}
+	if(!retval) std::cout << " ERROR: Failed to write to output file!\n";
+
+	return retval;
+}
+
+/** Open the output file, making sure that it is not the input file before it is truncated.
+  * \param[in]  fname_    Path to the output file.
+  * \param[in]  fdIn_     Descriptor of the input file.
+  * \param[in]  flags_    Access mode of the output file (O_WRONLY or O_RDWR).
+  * \param[in]  truncate_ Create the output file if it does not exist and truncate it to zero length.
+  * \return The descriptor of the output file, or -1 upon failure.
+  */
+int openOutput(const std::string &fname_, const int &fdIn_, const int &flags_, const bool &truncate_=true){
+	int fdOut = (truncate_ ? open(fname_.c_str(), flags_ | O_CREAT, 0644) : open(fname_.c_str(), flags_));
+	if(fdOut < 0){
+		std::cout << " ERROR: Failed to open output file \"" << fname_ << "\"!\n";
+		return -1;
+	}
+	if(isSameFile(fdIn_, fdOut)){
+		std::cout << " ERROR: Output file \"" << fname_ << "\" is the input file!\n";
+		close(fdOut);
+		return -1;
+	}
+	if(truncate_ && ftruncate(fdOut, 0) != 0){
+		std::cout << " ERROR: Failed to truncate output file \"" << fname_ << "\"!\n";
+		close(fdOut);
+		return -1;
+	}
+	return fdOut;
 }
 
 int main(int argc, char *argv[]){
@@ -55,6 +588,12 @@ int main(int argc, char *argv[]){
 	handler.add(optionExt("output", required_argument, NULL, 'o', "<filename>", "Specify the filename of the output ldf file"));
 	handler.add(optionExt("force", no_argument, NULL, 'f', "", "Force overwrite of the output ldf file"));
 	handler.add(optionExt("debug", no_argument, NULL, 'd', "", "Toggle debug mode"));
+	handler.add(optionExt("batch", no_argument, NULL, 'b', "", "Repair the file in a single streaming pass without asking for confirmation"));
+	handler.add(optionExt("threads", required_argument, NULL, 'j', "<int>", "Number of threads used to scan the input file (default=all cores)"));
+	handler.add(optionExt("validate", no_argument, NULL, 'V', "", "Check the chunk and spill framing of all DATA buffers and report damaged spills"));
+	handler.add(optionExt("duplicates", no_argument, NULL, 'D', "", "Find duplicate buffers and spills by hashing (use with --output to write a copy without the duplicate buffers)"));
+	handler.add(optionExt("checkpoint", required_argument, NULL, 'c', "<MB>", "Save a checkpoint (<output>.ckpt) every N MB of input in batch mode"));
+	handler.add(optionExt("resume", no_argument, NULL, 'r', "", "Resume an interrupted batch mode repair from its checkpoint"));
 
 	if(!handler.setup(argc, argv)){
 		return 1;
@@ -84,6 +623,29 @@ int main(int argc, char *argv[]){
 		debug = true;
 	}
 
+	bool batchMode = false;
+	if(handler.getOption(4)->active){
+		batchMode = true;
+	}
+
+	unsigned long long checkpointInterval = 0;
+	if(handler.getOption(8)->active){
+		checkpointInterval = strtoull(handler.getOption(8)->argument.c_str(), NULL, 0)*1048576ULL;
+		batchMode = true;
+	}
+
+	bool resume = false;
+	if(handler.getOption(9)->active){
+		resume = true;
+		batchMode = true;
+	}
+
+	unsigned int numThreads = std::thread::hardware_concurrency();
+	if(handler.getOption(5)->active){
+		numThreads = strtoul(handler.getOption(5)->argument.c_str(), NULL, 0);
+	}
+	if(numThreads == 0) numThreads = 1;
+
 	// Open the input file.
 	std::ifstream fin(ifname.c_str(), std::ios::binary);
 
@@ -92,8 +654,46 @@ int main(int argc, char *argv[]){
 		return 1;
 	}
 	
+	if(handler.getOption(6)->active){ // Validate the contents of DATA buffers.
+		fin.close();
+		mappedFile input;
+		if(!input.open(ifname) || !input.isMapped()){
+			std::cout << " ERROR: Failed to map input file \"" << ifname << "\"! A regular, non-empty file is required.\n";
+			return 1;
+		}
+		return (validate((const unsigned int*)input.getData(), input.getSize()/4, numThreads) == 0 ? 0 : 1);
+	}
+
+	if(handler.getOption(7)->active){ // Find duplicate buffers and spills.
+		fin.close();
+		mappedFile input;
+		if(!input.open(ifname) || !input.isMapped()){
+			std::cout << " ERROR: Failed to map input file \"" << ifname << "\"! A regular, non-empty file is required.\n";
+			return 1;
+		}
+
+		// Only write an output file if one was requested.
+		int fdOut = -1;
+		if(handler.getOption(1)->active){
+			if(!forceOverwrite && access(ofname.c_str(), F_OK) == 0){
+				std::cout << " ERROR: Output file \"" << ofname << "\" already exists!\n";
+				return 1;
+			}
+			fdOut = openOutput(ofname, input.getDescriptor(), O_WRONLY);
+			if(fdOut < 0) return 1;
+		}
+
+		bool retval = deduplicate((const unsigned int*)input.getData(), input.getSize(), numThreads, input.getDescriptor(), fdOut);
+		if(fdOut >= 0) close(fdOut);
+		if(!retval){
+			std::cout << " ERROR: Failed to write to output file!\n";
+			return 1;
+		}
+		return 0;
+	}
+
 	// Check that the output file doesn't exist.
-	if(!forceOverwrite){
+	if(!forceOverwrite && !resume){
 		std::ifstream fouttest(ofname.c_str(), std::ios::binary);
 		if(fouttest.good()){
 			std::cout << " ERROR: Output file \"" << ofname << "\" already exists!\n";
@@ -102,25 +702,107 @@ int main(int argc, char *argv[]){
 		}
 	}
 
-	// Open the output file.
-	std::ofstream fout(ofname.c_str(), std::ios::binary);
-
-	if(!fout.good()){
-		std::cout << " ERROR: Failed to open output file \"" << ofname << "\"!\n";
+	if(batchMode){ // Single pass, non-interactive repair.
 		fin.close();
-		return 1;
+
+		repairCheckpoint state;
+		const std::string checkpoint = repairCheckpoint::getSidecarName(ofname);
+		if(resume && !state.read(checkpoint)){
+			std::cout << " ERROR: Failed to read checkpoint \"" << checkpoint << "\"!\n";
+			return 1;
+		}
+		if(checkpointInterval > 0) state.interval = checkpointInterval;
+
+		// The output is also read back to hash the last block before each checkpoint. A resumed
+		// repair never creates the output file, since the checkpoint refers to its contents.
+		int fdIn = open(ifname.c_str(), O_RDONLY);
+		if(fdIn < 0){
+			std::cout << " ERROR: Failed to open input file \"" << ifname << "\"!\n";
+			return 1;
+		}
+		int fdOut = openOutput(ofname, fdIn, O_RDWR, !resume);
+		if(fdOut < 0){
+			close(fdIn);
+			return 1;
+		}
+
+		long long fileLength = lseek(fdIn, 0, SEEK_END);
+		std::cout << " Greetings gentlemen. I'm the fixer. I make buffer problems go away.\n";
+		std::cout << " Input file length is " << fileLength << " B (" << fileLength/4 << " words, " << fileLength/buffLengthB << 
+		             " ldf buffers w/ rem=" << (fileLength%buffLengthB)/4 << " words [delta=" << ((fileLength%buffLengthB)/4)-buffLength << "])\n\n";
+
+		if(resume){ // Discard any output written after the checkpoint.
+			if(!state.matches(fdIn)){
+				std::cout << " ERROR: Input file \"" << ifname << "\" has changed since the checkpoint was saved!\n";
+				close(fdIn);
+				close(fdOut);
+				return 1;
+			}
+			if(!state.matchesOutput(fdOut)){
+				std::cout << " ERROR: Output file \"" << ofname << "\" is shorter than " << state.outputOffset << " B or does not match the checkpoint!\n";
+				close(fdIn);
+				close(fdOut);
+				return 1;
+			}
+			if(ftruncate(fdOut, state.outputOffset) != 0 || lseek(fdOut, state.outputOffset, SEEK_SET) < 0){
+				std::cout << " ERROR: Failed to truncate output file \"" << ofname << "\"!\n";
+				close(fdIn);
+				close(fdOut);
+				return 1;
+			}
+			std::cout << " Resuming at input byte " << state.inputOffset << " (output byte " << state.outputOffset << ") with " << state.numBadBuffers << " invalid buffers found so far\n";
+			for(std::vector<bufferInfo>::iterator iter = state.anomalies.begin(); iter != state.anomalies.end(); ++iter)
+				std::cout << "  Buffer at position " << iter->offset << " contained " << iter->length << " words [delta=" << (long long)iter->length-buffLength << "]\n";
+			std::cout << std::endl;
+		}
+		else if(!state.setInput(fdIn)){
+			std::cout << " ERROR: Input file \"" << ifname << "\" is not a regular file!\n";
+			close(fdIn);
+			close(fdOut);
+			return 1;
+		}
+
+		bool retval = streamRepair(fdIn, fdOut, debug, state, checkpoint);
+
+		fileLength = lseek(fdOut, 0, SEEK_END);
+		close(fdIn);
+		close(fdOut);
+		if(!retval) return 1;
+
+		// The repair is complete, so the checkpoint is no longer needed.
+		if(state.interval > 0 || resume) unlink(checkpoint.c_str());
+
+		const unsigned long long &numBuffers = state.numBuffers;
+		const unsigned long long &numBadBuffers = state.numBadBuffers;
+		const unsigned long long &numRepaired = state.numRepaired;
+
+		if(numBadBuffers == 0){
+			std::cout << " Found no ldf buffer errors! Nothing to repair :-)\n";
+		}
+		else{
+			std::cout << "\n I found " << numBadBuffers << " invalid buffers of " << numBuffers << " total.\n";
+			std::cout << " DONE! Successfully repaired " << numRepaired << " invalid buffers.\n";
+		}
+		std::cout << " Output file length is " << fileLength << " B (" << fileLength/4 << " words, " << fileLength/buffLengthB << 
+		             " ldf buffers w/ rem=" << (fileLength%buffLengthB)/4 << " words [delta=" << ((fileLength%buffLengthB)/4)-buffLength << "])\n";
+
+		return 0;
 	}
 
-	unsigned int buffHeader;
+	fin.close();
 
-	std::streampos lastValidHeader = 0;
-	std::streampos prevBufferStart = 0;
+	// Map the input file so that it may be scanned in parallel.
+	mappedFile input;
+	if(!input.open(ifname) || !input.isMapped()){
+		std::cout << " ERROR: Failed to map input file \"" << ifname << "\"! A regular, non-empty file is required.\n";
+		return 1;
+	}
 
-	std::vector<buffer> fileBuffers;
+	// Open the output file.
+	int fdOut = openOutput(ofname, input.getDescriptor(), O_WRONLY);
+	if(fdOut < 0) return 1;
 
-	fin.seekg(0, std::ios::end);
-	std::streampos fileLength = fin.tellg();
-	fin.seekg(0, std::ios::beg);
+	std::streampos fileLength = input.getSize();
 	
 	std::cout << " Greetings gentlemen. I'm the fixer. I make buffer problems go away.\n";
 	
@@ -129,57 +811,26 @@ int main(int argc, char *argv[]){
 	             " ldf buffers w/ rem=" << (fileLength%buffLengthB)/4 << " words [delta=" << ((fileLength%buffLengthB)/4)-buffLength << "])\n\n";
 
 	int errorCount = 1;
-	int numBuffers = 0;
-	int numBadBuffers = 0;
+	unsigned long long numBuffers = 0;
+	unsigned long long numBadBuffers = 0;
 
-	// Scan the input file and search for buffer errors.	
-	while(true){
-		fin.read((char*)&buffHeader, 4);
-		
-		if(fin.eof()) break;
-		
-		if(validBuffer(buffHeader)){ // Skip the remaning words in the buffer.
-			lastValidHeader = fin.tellg();
-			fin.seekg(buffLengthB-4, std::ios::cur);
-			if(numBuffers > 0)
-				fileBuffers.push_back(buffer(prevBufferStart, buffLength));
-			prevBufferStart = lastValidHeader;
-			prevBufferStart += -4;
-			numBuffers++;
-			continue;
-		}
-		
-		// Rewind to just after the most recent good header.
-		fin.seekg(lastValidHeader, std::ios::beg);
-		int bufferLength = 1;
-		
-		// Search for the next valid buffer.
-		while(true){
-			fin.read((char*)&buffHeader, 4);
-			
-			if(fin.eof()) break;
-			
-			if(!validBuffer(buffHeader)){
-				bufferLength++;
-				continue;
-			}
-			
-			// We found the next good buffer.
-			std::cout << " " << errorCount++ << ") INVALID BUFFER no. " << fileBuffers.size()+1 << " at position " << lastValidHeader/4 << " in file. Buffer contains " << bufferLength << " words [delta=" << bufferLength-buffLength << "] ";
-			if(bufferLength < buffLength ) std::cout << "(UNDERFLOW)\n";
-			else std::cout << "(OVERFLOW)\n";
-			
-			fileBuffers.push_back(buffer(lastValidHeader, bufferLength));
-			lastValidHeader = fin.tellg();
-			fin.seekg(buffLengthB-4, std::ios::cur);
-			numBuffers++;
-			numBadBuffers++;
-			break;
-		}
-	}
-	
-	// Add the final buffer to the list.
-	fileBuffers.push_back(buffer(lastValidHeader, (int)(fileLength-lastValidHeader)/4+1));
+	// Scan the input file and search for buffer errors.
+	bufferMap fileBuffers;
+	size_t nChunks = scanBuffers((const unsigned int*)input.getData(), input.getSize()/4, numThreads, fileBuffers);
+	if(debug)
+		std::cout << "  DEBUG: Scanned " << input.getSize()/4 << " words in " << nChunks << " chunks (" << fileBuffers.runs.size() << " valid runs)\n";
+
+	fileBuffers.forEach([&](const bufferMap::run &run_){
+		if(debug)
+			std::cout << "  DEBUG: Found " << run_.numBuffers << " valid buffers at positions " << run_.offset << " to " << run_.end() << "\n";
+		numBuffers += run_.numBuffers;
+	}, [&](const bufferInfo &buff_){
+		numBuffers++;
+		std::cout << " " << errorCount++ << ") INVALID BUFFER no. " << numBuffers << " at position " << buff_.offset << " in file. Buffer contains " << buff_.length << " words [delta=" << (long long)buff_.length-buffLength << "] ";
+		if(buff_.length < (unsigned long long)buffLength) std::cout << "(UNDERFLOW)\n";
+		else std::cout << "(OVERFLOW)\n";
+		numBadBuffers++;
+	});
 	
 	if(numBadBuffers == 0){
 		std::cout << " Found no ldf buffer errors! Nothing to repair :-)\n";
@@ -200,51 +851,66 @@ int main(int argc, char *argv[]){
 		
 		if(userInput == "n" || userInput == "N"){
 			std::cout << " Aborting!\n";
-			fin.close();
-			fout.close();
+			close(fdOut);
 			return 0;
 		}
 
-		// Clear the eof state of the ifstream and seek to the beginning.
-		fin.clear();
-		fin.seekg(0, std::ios::beg);
-	
-		unsigned int data[buffLength];
+		const int fdIn = input.getDescriptor();
+		const unsigned int *words = (const unsigned int*)input.getData();
+		std::vector<unsigned int> repaired;
+
+		// Runs of valid buffers are copied without passing through user space.
+		bool retval = true;
+		auto copyWords = [&](const unsigned long long &offset_, const unsigned long long &nWords_){
+			if(retval && !copyFileRange(fdIn, offset_*4, fdOut, nWords_*4)) retval = false;
+		};
 	
 		errorCount = 1;
-		for(std::vector<buffer>::iterator iter = fileBuffers.begin(); iter != fileBuffers.end(); ++iter){
-			if(iter->valid){
-				fin.read((char*)data, buffLength*4);
-				if(debug)
-					std::cout << "  DEBUG: Copying buffer at position " << iter->startpos/4 << " [start=0x" << std::hex << data[0] << ", stop=0x" << data[buffLength-2] << std::dec << "]\n";
-				fout.write((char*)data, buffLength*4);
+		int numRepaired = 0;
+		fileBuffers.forEach([&](const bufferMap::run &run_){
+			if(debug)
+				std::cout << "  DEBUG: Copying " << run_.numBuffers << " buffers at position " << run_.offset << "\n";
+			copyWords(run_.offset, run_.numBuffers*buffLength);
+		}, [&](const bufferInfo &buff_){
+			if(!retval) return;
+			const unsigned int *data = words+buff_.offset;
+			std::cout << " Reparing buffer error no. " << errorCount++ << ")\n";
+			if(buff_.length > maxRepairLength){ // Too long to repair.
+				std::cout << " -Copying " << buff_.length << " words at position " << buff_.offset << "\n";
+				std::cout << " -WARNING: Buffer is too long to be repaired and was copied unchanged!\n\n";
+				copyWords(buff_.offset, buff_.length);
 			}
-			else{
-				std::cout << " Reparing buffer error no. " << errorCount++ << ")\n";
-				fin.read((char*)data, iter->length*4);
-				std::cout << " -Copying " << iter->length << " words at position " << iter->startpos/4 << "\n";
-				fout.write((char*)data, iter->length*4);				
-				if(buffLength > iter->length){ // Underfilled buffer.
-					std::cout << " -Appending " << buffLength-iter->length << " words to end of buffer\n\n";
-					for(int i = 0; i < buffLength-iter->length; i++){
-						fout.write((char*)&delimiter, 4);
-					}
-				}
-				else{ // Overfilled buffer.
-					std::cout << " -WARNING: Repair of overfilled buffers is not currently implemented!\n";
-				}
+			else if(buff_.length < (unsigned long long)buffLength){ // Underfilled buffer.
+				std::cout << " -Copying " << buff_.length << " words at position " << buff_.offset << "\n";
+				std::cout << " -Appending " << buffLength-buff_.length << " words to end of buffer\n\n";
+				repaired.assign(data, data+buff_.length);
+				repaired.resize(buffLength, delimiter);
+				if(!writeWords(fdOut, repaired.data(), repaired.size())) retval = false;
+				numRepaired++;
+			}
+			else{ // Overfilled buffer.
+				repaired.clear();
+				size_t nBuffers = splitBuffer(data, buff_.length, repaired);
+				std::cout << " -Splitting " << buff_.length << " words at position " << buff_.offset << " into " << nBuffers << " buffers\n\n";
+				if(!writeWords(fdOut, repaired.data(), repaired.size())) retval = false;
+				numRepaired++;
 			}
+		});
+
+		if(!retval){
+			std::cout << " ERROR: Failed to write to output file!\n";
+			close(fdOut);
+			return 1;
 		}
 		
 		// Report on what we did.
-		fileLength = fout.tellp();
-		std::cout << " DONE! Successfully repaired " << numBadBuffers << " invalid buffers!\n";
+		fileLength = lseek(fdOut, 0, SEEK_CUR);
+		std::cout << " DONE! Successfully repaired " << numRepaired << " invalid buffers!\n";
 		std::cout << " Output file length is " << fileLength << " B (" << fileLength/4 << " words, " << fileLength/buffLengthB << 
 			         " ldf buffers w/ rem=" << (fileLength%buffLengthB)/4 << " words [delta=" << ((fileLength%buffLengthB)/4)-buffLength << "])\n";
 	}
 	
-	fin.close();
-	fout.close();
+	close(fdOut);
 	
 	return 0;
 }
@@ -0,0 +1,123 @@
+/** \file mappedFile.cpp
+  * \brief Read-only memory mapped view of a binary data file.
+  *
+  * \author C. R. Thornsberry
+  * \date Oct. 16th, 2026
+  */
+
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "mappedFile.hpp"
+
+///////////////////////////////////////////////////////////////////////////////
+// class mappedFile
+///////////////////////////////////////////////////////////////////////////////
+
+mappedFile::mappedFile() : fd(-1), ownDescriptor(false), data(NULL), length(0) { }
+
+mappedFile::~mappedFile(){
+	this->close();
+}
+
+bool mappedFile::open(const std::string &fname_){
+	this->close();
+
+	if(fname_ == "-"){ // Read from stdin.
+		fd = STDIN_FILENO;
+		ownDescriptor = false;
+	}
+	else{
+		fd = ::open(fname_.c_str(), O_RDONLY);
+		if(fd < 0) return false;
+		ownDescriptor = true;
+	}
+
+	// Only regular files may be mapped. Everything else is streamed.
+	struct stat info;
+	if(fstat(fd, &info) != 0 || !S_ISREG(info.st_mode) || info.st_size <= 0)
+		return true;
+
+	void *addr = mmap(NULL, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	if(addr == MAP_FAILED) // Fall back to streaming the file.
+		return true;
+
+	data = (char*)addr;
+	length = info.st_size;
+
+	// We typically walk the file from beginning to end exactly once.
+	madvise(data, length, MADV_SEQUENTIAL);
+
+	return true;
+}
+
+void mappedFile::close(){
+	if(data){
+		munmap(data, length);
+		data = NULL;
+		length = 0;
+	}
+	if(fd >= 0 && ownDescriptor)
+		::close(fd);
+	fd = -1;
+	ownDescriptor = false;
+}
+
+void mappedFile::setRandomAccess(){
+	if(data) madvise(data, length, MADV_RANDOM);
+}
+
+size_t mappedFile::read(char *dest_, const size_t &len_){
+	size_t total = 0;
+	while(total < len_){
+		ssize_t retval = ::read(fd, dest_+total, len_-total);
+		if(retval < 0){
+			if(errno == EINTR) continue;
+			break;
+		}
+		else if(retval == 0) break; // End of stream.
+		total += retval;
+	}
+	return total;
+}
+
+size_t mappedFile::readAt(char *dest_, const size_t &len_, const unsigned long long &offset_) const {
+	size_t total = 0;
+	while(total < len_){
+		ssize_t retval = pread(fd, dest_+total, len_-total, offset_+total);
+		if(retval < 0){
+			if(errno == EINTR) continue;
+			break;
+		}
+		else if(retval == 0) break; // End of file.
+		total += retval;
+	}
+	return total;
+}
+
+unsigned long long mappedFile::getFileSize() const {
+	struct stat info;
+	if(fd < 0 || fstat(fd, &info) != 0 || !S_ISREG(info.st_mode)) return 0;
+	return info.st_size;
+}
+
+bool mappedFile::skip(const unsigned long long &nBytes_){
+	// Seekable descriptors do not need to read the skipped data.
+	if(lseek(fd, nBytes_, SEEK_CUR) != (off_t)-1)
+		return true;
+
+	std::vector<char> dummy(1048576);
+	unsigned long long remaining = nBytes_;
+	while(remaining > 0){
+		size_t request = (remaining < dummy.size() ? remaining : dummy.size());
+		size_t nRead = this->read(dummy.data(), request);
+		if(nRead == 0) return false;
+		remaining -= nRead;
+	}
+	return true;
+}
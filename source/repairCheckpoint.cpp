@@ -0,0 +1,178 @@
+/** \file repairCheckpoint.cpp
+  * \brief Persistent state of an interruptible streaming repair.
+  *
+  * \author C. R. Thornsberry
+  * \date Oct. 16th, 2026
+  */
+
+#include <fstream>
+#include <stdio.h>
+#include <string.h>
+
+#include <sys/stat.h>
+#include <unistd.h>
+#include <errno.h>
+
+#include "repairCheckpoint.hpp"
+#include "wordHash.hpp"
+
+namespace{
+	const char checkpointMagic[8] = {'L', 'D', 'F', 'C', 'K', 'P', 'T', '\0'};
+
+	/// Version of the checkpoint file format.
+	const unsigned int checkpointVersion = 3;
+
+	/// Write the lowest nBytes_ bytes of a value in little-endian byte order.
+	void writeValue(std::ostream &file_, const unsigned long long &value_, const size_t &nBytes_=8){
+		unsigned char bytes[8];
+		for(size_t i = 0; i < nBytes_; i++)
+			bytes[i] = (unsigned char)(value_ >> (8*i));
+		file_.write((char*)bytes, nBytes_);
+	}
+
+	/// Read a value of nBytes_ bytes in little-endian byte order.
+	template <typename T>
+	void readValue(std::istream &file_, T &value_, const size_t &nBytes_=8){
+		unsigned char bytes[8] = {0};
+		file_.read((char*)bytes, nBytes_);
+		unsigned long long value = 0;
+		for(size_t i = 0; i < nBytes_; i++)
+			value |= (unsigned long long)bytes[i] << (8*i);
+		value_ = (T)value;
+	}
+
+	/// Number of bytes written for each anomalous buffer (offset, type and length).
+	const unsigned long long anomalySize = 8+4+8;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// struct repairCheckpoint
+///////////////////////////////////////////////////////////////////////////////
+
+bool repairCheckpoint::setInput(const int &fd_){
+	struct stat info;
+	if(fstat(fd_, &info) != 0 || !S_ISREG(info.st_mode))
+		return false;
+	inputSize = info.st_size;
+	inputTime = (long long)info.st_mtim.tv_sec;
+	inputTimeNsec = (long long)info.st_mtim.tv_nsec;
+	inputInode = (unsigned long long)info.st_ino;
+	return true;
+}
+
+bool repairCheckpoint::matches(const int &fd_) const {
+	struct stat info;
+	if(fstat(fd_, &info) != 0 || !S_ISREG(info.st_mode))
+		return false;
+	return (inputSize == (unsigned long long)info.st_size && inputTime == (long long)info.st_mtim.tv_sec &&
+	        inputTimeNsec == (long long)info.st_mtim.tv_nsec && inputInode == (unsigned long long)info.st_ino);
+}
+
+bool repairCheckpoint::setOutput(const int &fd_, const unsigned long long &offset_){
+	outputOffset = offset_;
+	return hashOutput(fd_, outputOffset, outputHash);
+}
+
+bool repairCheckpoint::matchesOutput(const int &fd_) const {
+	struct stat info;
+	if(fstat(fd_, &info) != 0 || (unsigned long long)info.st_size < outputOffset)
+		return false;
+	unsigned long long hash;
+	return (hashOutput(fd_, outputOffset, hash) && hash == outputHash);
+}
+
+bool repairCheckpoint::read(const std::string &fname_){
+	anomalies.clear();
+
+	std::ifstream file(fname_.c_str(), std::ios::binary);
+	if(!file.good()) return false;
+
+	char magic[8];
+	unsigned int version = 0;
+	unsigned long long count = 0;
+	file.read(magic, 8);
+	readValue(file, version, 4);
+	if(!file.good() || memcmp(magic, checkpointMagic, 8) != 0 || version != checkpointVersion)
+		return false;
+
+	readValue(file, inputSize);
+	readValue(file, inputTime);
+	readValue(file, inputTimeNsec);
+	readValue(file, inputInode);
+	readValue(file, inputOffset);
+	readValue(file, outputOffset);
+	readValue(file, outputHash);
+	readValue(file, interval);
+	readValue(file, numBuffers);
+	readValue(file, numBadBuffers);
+	readValue(file, numRepaired);
+	readValue(file, count);
+	if(!file.good()) return false;
+
+	// Make sure the checkpoint is long enough to hold all of its anomalies.
+	std::streampos start = file.tellg();
+	file.seekg(0, std::ios::end);
+	if((unsigned long long)(file.tellg()-start) != count*anomalySize)
+		return false;
+	file.seekg(start);
+
+	anomalies.resize(count);
+	for(std::vector<bufferInfo>::iterator iter = anomalies.begin(); iter != anomalies.end(); ++iter){
+		readValue(file, iter->offset);
+		readValue(file, iter->type, 4);
+		readValue(file, iter->length);
+	}
+	if(!file.good()){
+		anomalies.clear();
+		return false;
+	}
+
+	return true;
+}
+
+bool repairCheckpoint::write(const std::string &fname_) const {
+	std::string temp = fname_+".tmp";
+	{
+		std::ofstream file(temp.c_str(), std::ios::binary);
+		if(!file.good()) return false;
+
+		file.write(checkpointMagic, 8);
+		writeValue(file, checkpointVersion, 4);
+		writeValue(file, inputSize);
+		writeValue(file, (unsigned long long)inputTime);
+	writeValue(file, (unsigned long long)inputTimeNsec);
+	writeValue(file, inputInode);
+		writeValue(file, inputOffset);
+		writeValue(file, outputOffset);
+		writeValue(file, outputHash);
+		writeValue(file, interval);
+		writeValue(file, numBuffers);
+		writeValue(file, numBadBuffers);
+		writeValue(file, numRepaired);
+		writeValue(file, anomalies.size());
+		for(std::vector<bufferInfo>::const_iterator iter = anomalies.begin(); iter != anomalies.end(); ++iter){
+			writeValue(file, iter->offset);
+			writeValue(file, iter->type, 4);
+			writeValue(file, iter->length);
+		}
+		if(!file.good()) return false;
+	}
+
+	return (rename(temp.c_str(), fname_.c_str()) == 0);
+}
+
+bool repairCheckpoint::hashOutput(const int &fd_, const unsigned long long &offset_, unsigned long long &hash_){
+	// Hash the last buffer length of output (or less at the start of the file).
+	const unsigned long long nBytes = (offset_ < ldfBufferLength*4ULL ? offset_ : ldfBufferLength*4ULL) & ~3ULL;
+	std::vector<unsigned int> block(nBytes/4);
+	char *data = (char*)block.data();
+	unsigned long long done = 0;
+	while(done < nBytes){
+		ssize_t retval = pread(fd_, data+done, nBytes-done, offset_-nBytes+done);
+		if(retval < 0 && errno == EINTR) continue;
+		if(retval <= 0) return false;
+		done += retval;
+	}
+	hash_ = hashWords(block.data(), block.size());
+	return true;
+}
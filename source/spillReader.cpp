@@ -0,0 +1,123 @@
+/** \file spillReader.cpp
+  * \brief Reassembles ldf spills and decodes Pixie16 list mode channel headers.
+  *
+  * \author C. R. Thornsberry
+  * \date Oct. 16th, 2026
+  */
+
+#include "spillReader.hpp"
+
+namespace{
+	/// Return true if a header length is one of the lengths listed in DataProcessing::HEADER_CODES.
+	bool validHeaderLength(const unsigned int &length_){
+		switch(length_){
+			case DataProcessing::HEADER:
+			case DataProcessing::HEADER_W_ETS:
+			case DataProcessing::HEADER_W_ESUM:
+			case DataProcessing::HEADER_W_ESUM_ETS:
+			case DataProcessing::HEADER_W_QDC:
+			case DataProcessing::HEADER_W_QDC_ETS:
+			case DataProcessing::HEADER_W_ESUM_QDC:
+			case DataProcessing::HEADER_W_ESUM_QDC_ETS:
+				return true;
+			default:
+				return false;
+		}
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// struct channelHeaders
+///////////////////////////////////////////////////////////////////////////////
+
+void channelHeaders::clear(){
+	word0.clear();
+	word1.clear();
+	word2.clear();
+	word3.clear();
+}
+
+bool channelHeaders::decode(const unsigned int *data_, const size_t &nWords_){
+	this->clear();
+
+	// Locate the start of every event in the module.
+	bool retval = true;
+	size_t pos = 0;
+	while(pos+4 <= nWords_){
+		const unsigned int w0 = data_[pos];
+		const unsigned int hLength = (w0 & 0x0001F000) >> 12;
+		const unsigned int eLength = (w0 & 0x7FFE0000) >> 17;
+		if(!validHeaderLength(hLength) || eLength < hLength || pos+eLength > nWords_){
+			retval = false;
+			break;
+		}
+		word0.push_back(w0);
+		word1.push_back(data_[pos+1]);
+		word2.push_back(data_[pos+2]);
+		word3.push_back(data_[pos+3]);
+		pos += eLength;
+	}
+	if(pos != nWords_) retval = false;
+
+	// Extract each field for the whole batch at once.
+	const size_t count = word0.size();
+	channel.resize(count);
+	slot.resize(count);
+	crate.resize(count);
+	headerLength.resize(count);
+	eventLength.resize(count);
+	energy.resize(count);
+	traceLength.resize(count);
+	cfdTime.resize(count);
+	time.resize(count);
+	pileup.resize(count);
+	saturated.resize(count);
+
+	for(size_t i = 0; i < count; i++){
+		channel[i] = word0[i] & 0x0000000F;
+		slot[i] = (word0[i] & 0x000000F0) >> 4;
+		crate[i] = (word0[i] & 0x00000F00) >> 8;
+		headerLength[i] = (word0[i] & 0x0001F000) >> 12;
+		eventLength[i] = (word0[i] & 0x7FFE0000) >> 17;
+		pileup[i] = word0[i] >> 31;
+	}
+	for(size_t i = 0; i < count; i++){
+		time[i] = ((unsigned long long)(word2[i] & 0x0000FFFF) << 32) | word1[i];
+		cfdTime[i] = word2[i] >> 16;
+	}
+	for(size_t i = 0; i < count; i++){
+		energy[i] = word3[i] & 0x0000FFFF;
+		traceLength[i] = (word3[i] & 0x7FFF0000) >> 16;
+		saturated[i] = word3[i] >> 31;
+	}
+
+	return retval;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// class spillReader
+///////////////////////////////////////////////////////////////////////////////
+
+void spillReader::reset(){
+	spill.clear();
+	inSpill = false;
+	numChunks = 0;
+	nextChunk = 0;
+	spillBuffer = NULL;
+	spillPos = 0;
+	numSpills = 0;
+	numStarted = 0;
+	numErrors = 0;
+}
+
+const char *spillReader::getStatusName(const STATUS &status_){
+	switch(status_){
+		case OK: return "OK";
+		case BAD_CHUNK_SIZE: return "BAD CHUNK SIZE";
+		case BAD_CHUNK_NUMBER: return "BAD CHUNK NUMBER";
+		case BAD_CHUNK_COUNT: return "BAD CHUNK COUNT";
+		case MISSING_CHUNKS: return "MISSING CHUNKS";
+		case BAD_FOOTER: return "BAD SPILL FOOTER";
+		default: return "UNKNOWN";
+	}
+}
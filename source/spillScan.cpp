@@ -0,0 +1,43 @@
+/** \file spillScan.cpp
+  * \brief Reassembles the spills of a span of ldf buffers using multiple threads.
+  *
+  * \author C. R. Thornsberry
+  * \date Oct. 16th, 2026
+  */
+
+#include "spillScan.hpp"
+
+size_t findSpillStart(const unsigned int *words_, const size_t &length_){
+	size_t pos = 2;
+	while(pos+3 <= length_ && words_[pos] != 0xFFFFFFFF){
+		if(words_[pos+2] == 0) return pos;
+		if(words_[pos] % 4 != 0 || words_[pos]/4 < 3 || pos+words_[pos]/4 > length_) break;
+		pos += words_[pos]/4;
+	}
+	return length_;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// class spillScan
+///////////////////////////////////////////////////////////////////////////////
+
+bool spillScan::readSpill(const spillStart &start_, std::vector<unsigned int> &spill_) const {
+	spillReader reader;
+	bool done = false;
+	size_t pos = start_.offset;
+	size_t first = start_.pos;
+	while(pos < nWords && !done){
+		size_t nextPos = scanner.next(pos, nWords);
+		if(words[pos] == DATA){
+			reader.read(words+pos, nextPos-pos, [&](const std::vector<unsigned int> &data_){
+				if(done) return;
+				spill_ = data_;
+				done = true;
+			}, [](const spillReader::STATUS &, const size_t &){ }, first);
+			if(!done && !reader.inProgress()) return false;
+			first = 2;
+		}
+		pos = nextPos;
+	}
+	return done;
+}
@@ -0,0 +1,91 @@
+/** \file wordHash.cpp
+  * \brief Fast non-cryptographic hashing of blocks of words.
+  *
+  * \author C. R. Thornsberry
+  * \date Oct. 16th, 2026
+  */
+
+#include <string.h>
+
+#include "wordHash.hpp"
+
+namespace{
+	const unsigned long long prime1 = 11400714785074694791ULL;
+	const unsigned long long prime2 = 14029467366897019727ULL;
+	const unsigned long long prime3 = 1609587929392839161ULL;
+	const unsigned long long prime4 = 9650029242287828579ULL;
+	const unsigned long long prime5 = 2870177450012600261ULL;
+
+	inline unsigned long long rotateLeft(const unsigned long long &value_, const int &bits_){
+		return (value_ << bits_) | (value_ >> (64-bits_));
+	}
+
+	inline unsigned long long read64(const unsigned char *ptr_){
+		unsigned long long value;
+		memcpy(&value, ptr_, 8);
+		return value;
+	}
+
+	inline unsigned long long round(unsigned long long acc_, const unsigned long long &input_){
+		acc_ += input_*prime2;
+		acc_ = rotateLeft(acc_, 31);
+		return acc_*prime1;
+	}
+
+	inline unsigned long long mergeRound(unsigned long long acc_, const unsigned long long &value_){
+		acc_ ^= round(0, value_);
+		return acc_*prime1+prime4;
+	}
+}
+
+unsigned long long hashWords(const unsigned int *words_, const size_t &nWords_, const unsigned long long &seed_/*=0*/){
+	const unsigned char *ptr = (const unsigned char*)words_;
+	const unsigned char *end = ptr+nWords_*4;
+	unsigned long long hash;
+
+	if(nWords_*4 >= 32){
+		unsigned long long acc1 = seed_+prime1+prime2;
+		unsigned long long acc2 = seed_+prime2;
+		unsigned long long acc3 = seed_;
+		unsigned long long acc4 = seed_-prime1;
+		const unsigned char *limit = end-32;
+		do{
+			acc1 = round(acc1, read64(ptr));
+			acc2 = round(acc2, read64(ptr+8));
+			acc3 = round(acc3, read64(ptr+16));
+			acc4 = round(acc4, read64(ptr+24));
+			ptr += 32;
+		} while(ptr <= limit);
+
+		hash = rotateLeft(acc1, 1)+rotateLeft(acc2, 7)+rotateLeft(acc3, 12)+rotateLeft(acc4, 18);
+		hash = mergeRound(hash, acc1);
+		hash = mergeRound(hash, acc2);
+		hash = mergeRound(hash, acc3);
+		hash = mergeRound(hash, acc4);
+	}
+	else hash = seed_+prime5;
+
+	hash += nWords_*4;
+
+	// Hash the remaining words.
+	while(ptr+8 <= end){
+		hash ^= round(0, read64(ptr));
+		hash = rotateLeft(hash, 27)*prime1+prime4;
+		ptr += 8;
+	}
+	if(ptr+4 <= end){
+		unsigned int word;
+		memcpy(&word, ptr, 4);
+		hash ^= (unsigned long long)word*prime1;
+		hash = rotateLeft(hash, 23)*prime2+prime3;
+	}
+
+	// Final avalanche.
+	hash ^= hash >> 33;
+	hash *= prime2;
+	hash ^= hash >> 29;
+	hash *= prime3;
+	hash ^= hash >> 32;
+
+	return hash;
+}
@@ -0,0 +1,256 @@
+/** \file wordSearch.cpp
+  * \brief Vectorized multi-needle search over spans of data words.
+  *
+  * \author C. R. Thornsberry
+  * \date Oct. 16th, 2026
+  */
+
+#include "wordSearch.hpp"
+
+#if defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__))
+#include <immintrin.h>
+#define WORD_SEARCH_X86
+#endif
+
+namespace{
+	template <typename T>
+	const T *findScalar(const T *begin_, const T *end_, const T *needles_, const size_t &nNeedles_){
+		for(const T *ptr = begin_; ptr != end_; ++ptr){
+			for(size_t i = 0; i < nNeedles_; i++){
+				if(*ptr == needles_[i]) return ptr;
+			}
+		}
+		return end_;
+	}
+
+	/// Find the first word in [begin_, end_) for which (word & mask_) == value_.
+	template <typename T>
+	const T *findMaskedScalar(const T *begin_, const T *end_, const T &value_, const T &mask_){
+		for(const T *ptr = begin_; ptr != end_; ++ptr){
+			if((*ptr & mask_) == value_) return ptr;
+		}
+		return end_;
+	}
+
+#ifdef WORD_SEARCH_X86
+	/// Per word size SSE2 broadcast and compare operations.
+	template <size_t N> struct sse2Ops;
+
+	template <> struct sse2Ops<1>{
+		static __m128i set1(const unsigned char &val_){ return _mm_set1_epi8((char)val_); }
+		static __m128i cmpeq(const __m128i &a_, const __m128i &b_){ return _mm_cmpeq_epi8(a_, b_); }
+	};
+
+	template <> struct sse2Ops<2>{
+		static __m128i set1(const unsigned short &val_){ return _mm_set1_epi16((short)val_); }
+		static __m128i cmpeq(const __m128i &a_, const __m128i &b_){ return _mm_cmpeq_epi16(a_, b_); }
+	};
+
+	template <> struct sse2Ops<4>{
+		static __m128i set1(const unsigned int &val_){ return _mm_set1_epi32((int)val_); }
+		static __m128i cmpeq(const __m128i &a_, const __m128i &b_){ return _mm_cmpeq_epi32(a_, b_); }
+	};
+
+	template <> struct sse2Ops<8>{
+		static __m128i set1(const unsigned long long &val_){ return _mm_set1_epi64x((long long)val_); }
+		static __m128i cmpeq(const __m128i &a_, const __m128i &b_){ // SSE2 has no 64-bit compare. Combine both 32-bit halves.
+			__m128i halves = _mm_cmpeq_epi32(a_, b_);
+			return _mm_and_si128(halves, _mm_shuffle_epi32(halves, _MM_SHUFFLE(2, 3, 0, 1)));
+		}
+	};
+
+	/// Per word size AVX2 broadcast and compare operations.
+	template <size_t N> struct avx2Ops;
+
+	template <> struct avx2Ops<1>{
+		__attribute__((target("avx2"))) static __m256i set1(const unsigned char &val_){ return _mm256_set1_epi8((char)val_); }
+		__attribute__((target("avx2"))) static __m256i cmpeq(const __m256i &a_, const __m256i &b_){ return _mm256_cmpeq_epi8(a_, b_); }
+	};
+
+	template <> struct avx2Ops<2>{
+		__attribute__((target("avx2"))) static __m256i set1(const unsigned short &val_){ return _mm256_set1_epi16((short)val_); }
+		__attribute__((target("avx2"))) static __m256i cmpeq(const __m256i &a_, const __m256i &b_){ return _mm256_cmpeq_epi16(a_, b_); }
+	};
+
+	template <> struct avx2Ops<4>{
+		__attribute__((target("avx2"))) static __m256i set1(const unsigned int &val_){ return _mm256_set1_epi32((int)val_); }
+		__attribute__((target("avx2"))) static __m256i cmpeq(const __m256i &a_, const __m256i &b_){ return _mm256_cmpeq_epi32(a_, b_); }
+	};
+
+	template <> struct avx2Ops<8>{
+		__attribute__((target("avx2"))) static __m256i set1(const unsigned long long &val_){ return _mm256_set1_epi64x((long long)val_); }
+		__attribute__((target("avx2"))) static __m256i cmpeq(const __m256i &a_, const __m256i &b_){ return _mm256_cmpeq_epi64(a_, b_); }
+	};
+
+	template <typename T>
+	const T *findSSE2(const T *begin_, const T *end_, const T *needles_, const size_t &nNeedles_){
+		typedef sse2Ops<sizeof(T)> ops;
+		const size_t lanes = 16/sizeof(T);
+
+		__m128i keys[wordSearch<T>::maxNeedles];
+		for(size_t i = 0; i < nNeedles_; i++)
+			keys[i] = ops::set1(needles_[i]);
+
+		const T *ptr = begin_;
+		for(; (size_t)(end_-ptr) >= lanes; ptr += lanes){
+			__m128i block = _mm_loadu_si128((const __m128i*)ptr);
+			__m128i hits = ops::cmpeq(block, keys[0]);
+			for(size_t i = 1; i < nNeedles_; i++)
+				hits = _mm_or_si128(hits, ops::cmpeq(block, keys[i]));
+			int mask = _mm_movemask_epi8(hits);
+			if(mask != 0) // Every byte of a matching word is set, so the lowest bit marks the first match.
+				return ptr + __builtin_ctz(mask)/sizeof(T);
+		}
+
+		return findScalar(ptr, end_, needles_, nNeedles_);
+	}
+
+	template <typename T>
+	__attribute__((target("avx2"))) const T *findAVX2(const T *begin_, const T *end_, const T *needles_, const size_t &nNeedles_){
+		typedef avx2Ops<sizeof(T)> ops;
+		const size_t lanes = 32/sizeof(T);
+
+		__m256i keys[wordSearch<T>::maxNeedles];
+		for(size_t i = 0; i < nNeedles_; i++)
+			keys[i] = ops::set1(needles_[i]);
+
+		const T *ptr = begin_;
+		for(; (size_t)(end_-ptr) >= lanes; ptr += lanes){
+			__m256i block = _mm256_loadu_si256((const __m256i*)ptr);
+			__m256i hits = ops::cmpeq(block, keys[0]);
+			for(size_t i = 1; i < nNeedles_; i++)
+				hits = _mm256_or_si256(hits, ops::cmpeq(block, keys[i]));
+			unsigned int mask = (unsigned int)_mm256_movemask_epi8(hits);
+			if(mask != 0)
+				return ptr + __builtin_ctz(mask)/sizeof(T);
+		}
+
+		return findScalar(ptr, end_, needles_, nNeedles_);
+	}
+
+	template <typename T>
+	const T *findMaskedSSE2(const T *begin_, const T *end_, const T &value_, const T &mask_){
+		typedef sse2Ops<sizeof(T)> ops;
+		const size_t lanes = 16/sizeof(T);
+		const __m128i key = ops::set1(value_);
+		const __m128i bits = ops::set1(mask_);
+
+		const T *ptr = begin_;
+		for(; (size_t)(end_-ptr) >= lanes; ptr += lanes){
+			__m128i block = _mm_and_si128(_mm_loadu_si128((const __m128i*)ptr), bits);
+			int mask = _mm_movemask_epi8(ops::cmpeq(block, key));
+			if(mask != 0)
+				return ptr + __builtin_ctz(mask)/sizeof(T);
+		}
+
+		return findMaskedScalar(ptr, end_, value_, mask_);
+	}
+
+	template <typename T>
+	__attribute__((target("avx2"))) const T *findMaskedAVX2(const T *begin_, const T *end_, const T &value_, const T &mask_){
+		typedef avx2Ops<sizeof(T)> ops;
+		const size_t lanes = 32/sizeof(T);
+		const __m256i key = ops::set1(value_);
+		const __m256i bits = ops::set1(mask_);
+
+		const T *ptr = begin_;
+		for(; (size_t)(end_-ptr) >= lanes; ptr += lanes){
+			__m256i block = _mm256_and_si256(_mm256_loadu_si256((const __m256i*)ptr), bits);
+			unsigned int mask = (unsigned int)_mm256_movemask_epi8(ops::cmpeq(block, key));
+			if(mask != 0)
+				return ptr + __builtin_ctz(mask)/sizeof(T);
+		}
+
+		return findMaskedScalar(ptr, end_, value_, mask_);
+	}
+
+	bool haveAVX2(){
+		static const bool avx2 = __builtin_cpu_supports("avx2");
+		return avx2;
+	}
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// class wordSearch
+///////////////////////////////////////////////////////////////////////////////
+
+template <typename T>
+wordSearch<T>::wordSearch(const std::vector<T> &needles_){
+	for(typename std::vector<T>::const_iterator iter = needles_.begin(); iter != needles_.end(); ++iter)
+		this->add(*iter);
+}
+
+template <typename T>
+bool wordSearch<T>::add(const T &needle_){
+	if(needles.size() >= maxNeedles) return false;
+	needles.push_back(needle_);
+	return true;
+}
+
+template <typename T>
+const T *wordSearch<T>::find(const T *begin_, const T *end_) const {
+	if(needles.empty() || begin_ >= end_) return end_;
+#ifdef WORD_SEARCH_X86
+	if(haveAVX2()) return findAVX2(begin_, end_, needles.data(), needles.size());
+	return findSSE2(begin_, end_, needles.data(), needles.size());
+#else
+	return findScalar(begin_, end_, needles.data(), needles.size());
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// class sequenceSearch
+///////////////////////////////////////////////////////////////////////////////
+
+template <typename T>
+void sequenceSearch<T>::add(const T &value_, const T &mask_/*=(T)(-1)*/){
+	values.push_back(value_ & mask_);
+	masks.push_back(mask_);
+
+	// Anchor the search on the word with the most mask bits.
+	if(__builtin_popcountll(mask_) > __builtin_popcountll(masks[anchor]))
+		anchor = masks.size()-1;
+}
+
+template <typename T>
+const T *sequenceSearch<T>::find(const T *begin_, const T *end_) const {
+	const size_t length = values.size();
+	if(length == 0 || (size_t)(end_-begin_) < length) return end_;
+
+	// Candidate anchor positions must leave room for the entire sequence.
+	const T *limit = end_-(length-1-anchor);
+	const T *ptr = begin_+anchor;
+	while(ptr < limit){
+#ifdef WORD_SEARCH_X86
+		if(haveAVX2()) ptr = findMaskedAVX2(ptr, limit, values[anchor], masks[anchor]);
+		else ptr = findMaskedSSE2(ptr, limit, values[anchor], masks[anchor]);
+#else
+		ptr = findMaskedScalar(ptr, limit, values[anchor], masks[anchor]);
+#endif
+		if(ptr == limit) break;
+		if(this->match(ptr-anchor)) return ptr-anchor;
+		++ptr;
+	}
+
+	return end_;
+}
+
+const char *wordSearchInstructionSet(){
+#ifdef WORD_SEARCH_X86
+	if(haveAVX2()) return "avx2";
+	return "sse2";
+#else
+	return "scalar";
+#endif
+}
+
+template class wordSearch<unsigned char>;
+template class wordSearch<unsigned short>;
+template class wordSearch<unsigned int>;
+template class wordSearch<unsigned long long>;
+
+template class sequenceSearch<unsigned char>;
+template class sequenceSearch<unsigned short>;
+template class sequenceSearch<unsigned int>;
+template class sequenceSearch<unsigned long long>;
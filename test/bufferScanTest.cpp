@@ -0,0 +1,65 @@
+/** \file bufferScanTest.cpp
+  * \brief Checks that a chunked buffer scan finds the same buffers for any number of threads.
+  *
+  * \author C. R. Thornsberry
+  * \date Oct. 16th, 2026
+  */
+
+#include <iostream>
+#include <vector>
+
+#include "bufferScan.hpp"
+
+/// Build a span of DATA buffers where one buffer is short and every grid boundary after it holds a DATA word inside a payload.
+std::vector<unsigned int> buildMisaligned(const size_t &nBuffers_, const size_t &shortBuffer_, const size_t &shortLength_){
+	std::vector<unsigned int> words;
+	for(size_t i = 0; i < nBuffers_; i++){
+		const size_t length = (i == shortBuffer_ ? shortLength_ : ldfBufferLength);
+		words.push_back(DATA);
+		words.push_back(ldfBufferLength-2);
+		for(size_t j = 2; j < length; j++)
+			words.push_back((unsigned int)(i*ldfBufferLength+j));
+	}
+	for(size_t pos = (shortBuffer_+2)*ldfBufferLength+10; pos < words.size(); pos += ldfBufferLength)
+		words[pos] = DATA;
+	return words;
+}
+
+/// Scan a span using a number of threads and return all buffers in file order.
+std::vector<bufferInfo> scan(const std::vector<unsigned int> &words_, const size_t &nThreads_){
+	bufferScan scanner(words_.data(), words_.size());
+	std::vector<std::vector<bufferInfo> > chunks(nThreads_ > 0 ? nThreads_ : 1);
+	scanner.walkParallel(nThreads_, [&](const size_t &chunk_, const bufferInfo &buff_){
+		chunks[chunk_].push_back(buff_);
+	});
+	std::vector<bufferInfo> buffers;
+	for(size_t i = 0; i < chunks.size(); i++)
+		buffers.insert(buffers.end(), chunks[i].begin(), chunks[i].end());
+	return buffers;
+}
+
+int main(){
+	std::vector<unsigned int> words = buildMisaligned(97, 2, ldfBufferLength-100);
+	std::vector<bufferInfo> expected = scan(words, 1);
+
+	int retval = 0;
+	if(expected.size() != 97){
+		std::cout << " ERROR: Found " << expected.size() << " buffers using 1 thread, expected 97!\n";
+		retval = 1;
+	}
+
+	for(size_t nThreads = 2; nThreads <= 16; nThreads++){
+		std::vector<bufferInfo> buffers = scan(words, nThreads);
+		bool match = (buffers.size() == expected.size());
+		for(size_t i = 0; match && i < buffers.size(); i++)
+			match = (buffers[i].offset == expected[i].offset && buffers[i].length == expected[i].length);
+		if(!match){
+			std::cout << " ERROR: Scan using " << nThreads << " threads found " << buffers.size() << " buffers, expected " << expected.size() << "!\n";
+			retval = 1;
+		}
+	}
+
+	if(retval == 0) std::cout << " Buffer scans match for 1 to 16 threads.\n";
+
+	return retval;
+}
@@ -0,0 +1,347 @@
+/** \file ldfFixerTest.cpp
+  * \brief Runs ldfFixer on synthetic ldf files and checks the repaired output word for word.
+  *
+  * Usage: ldfFixerTest <path to ldfFixer> <work directory>
+  *
+  * \author C. R. Thornsberry
+  * \date Oct. 16th, 2026
+  */
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <random>
+#include <stdlib.h>
+#include <string.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+
+#include "bufferScan.hpp"
+#include "spillReader.hpp"
+
+const unsigned int delimiter = 0xFFFFFFFF;
+
+typedef std::vector<unsigned int> buffer;
+
+///////////////////////////////////////////////////////////////////////////////
+// class ldfBuilder
+///////////////////////////////////////////////////////////////////////////////
+
+/** Builds a synthetic ldf file buffer by buffer. Spills are split into chunks which
+  * are packed into DATA buffers the same way poll2 does, and no payload word is ever
+  * a buffer type word or a delimiter.
+  */
+class ldfBuilder{
+  public:
+	std::vector<buffer> buffers; ///< The buffers of the file, each padded to the ldf buffer length.
+
+	ldfBuilder(const unsigned int &seed_) : rng(seed_) { }
+
+	/// Return a random payload word.
+	unsigned int word(){
+		unsigned int value = rng();
+		while(isBufferHeader(value) || value == delimiter) value = rng();
+		return value;
+	}
+
+	/// Append a buffer of a given type with nWords_ random payload words.
+	void addBuffer(const unsigned int &type_, const size_t &nWords_){
+		buffer buff(1, type_);
+		buff.push_back(ldfBufferLength-2);
+		for(size_t i = 0; i < nWords_; i++) buff.push_back(this->word());
+		buff.resize(ldfBufferLength, delimiter);
+		buffers.push_back(buff);
+	}
+
+	/** Append a spill of module records, followed by the end of spill marker.
+	  * \return The number of DATA buffers used by the spill.
+	  */
+	size_t addSpill(const size_t &nModules_, const size_t &moduleLength_){
+		buffer data;
+		for(size_t i = 0; i < nModules_; i++){
+			data.push_back(moduleLength_+2);
+			data.push_back(i);
+			for(size_t j = 0; j < moduleLength_; j++) data.push_back(this->word());
+		}
+
+		// Split the spill into chunks, leaving room for the chunk headers.
+		const size_t maxChunk = ldfBufferLength-2-3;
+		std::vector<buffer> chunks;
+		for(size_t pos = 0; pos < data.size(); pos += maxChunk)
+			chunks.push_back(buffer(data.begin()+pos, data.begin()+(pos+maxChunk < data.size() ? pos+maxChunk : data.size())));
+		chunks.push_back(buffer({2, endOfSpillVsn}));
+
+		size_t nBuffers = 1;
+		buffer current = {DATA, ldfBufferLength-2};
+		for(size_t i = 0; i < chunks.size(); i++){
+			if(current.size()+3+chunks[i].size() > ldfBufferLength){
+				current.resize(ldfBufferLength, delimiter);
+				buffers.push_back(current);
+				current = {DATA, ldfBufferLength-2};
+				nBuffers++;
+			}
+			current.push_back((chunks[i].size()+3)*4);
+			current.push_back(chunks.size());
+			current.push_back(i);
+			current.insert(current.end(), chunks[i].begin(), chunks[i].end());
+		}
+		current.resize(ldfBufferLength, delimiter);
+		buffers.push_back(current);
+
+		return nBuffers;
+	}
+
+	/// Return all buffers of the file as a single list of words.
+	buffer getWords() const {
+		buffer words;
+		for(std::vector<buffer>::const_iterator iter = buffers.begin(); iter != buffers.end(); ++iter)
+			words.insert(words.end(), iter->begin(), iter->end());
+		return words;
+	}
+
+  private:
+	std::mt19937 rng; ///< Source of the payload words.
+};
+
+/// Write a list of words to a file.
+bool writeFile(const std::string &fname_, const buffer &words_){
+	std::ofstream file(fname_.c_str(), std::ios::binary);
+	file.write((const char*)words_.data(), words_.size()*4);
+	return file.good();
+}
+
+/// Read a file as a list of words.
+buffer readFile(const std::string &fname_){
+	std::ifstream file(fname_.c_str(), std::ios::binary);
+	std::stringstream stream;
+	stream << file.rdbuf();
+	const std::string data = stream.str();
+	buffer words(data.size()/4);
+	if(!words.empty()) memcpy(words.data(), data.data(), words.size()*4);
+	return words;
+}
+
+/// Return the contents of a text file.
+std::string readText(const std::string &fname_){
+	std::ifstream file(fname_.c_str());
+	std::stringstream stream;
+	stream << file.rdbuf();
+	return stream.str();
+}
+
+/** Run a program with its output redirected to a log file.
+  * \param[in]  args_      The program followed by its arguments.
+  * \param[in]  log_       Path to the log file.
+  * \param[in]  input_     Text written to the standard input of the program.
+  * \param[in]  fileLimit_ Maximum size of any file written by the program in bytes (no limit if zero).
+  * \return The exit status of the program, or -1 if it did not exit normally.
+  */
+int run(const std::vector<std::string> &args_, const std::string &log_, const std::string &input_="", const unsigned long long &fileLimit_=0){
+	const std::string inputName = log_+".in";
+	{
+		std::ofstream file(inputName.c_str());
+		file << input_;
+	}
+
+	pid_t pid = fork();
+	if(pid == 0){
+		int fdLog = open(log_.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+		int fdInput = open(inputName.c_str(), O_RDONLY);
+		if(fdLog < 0 || fdInput < 0) _exit(127);
+		dup2(fdInput, 0);
+		dup2(fdLog, 1);
+		dup2(fdLog, 2);
+		if(fileLimit_ > 0){ // Writes beyond the limit fail with EFBIG instead of raising SIGXFSZ.
+			struct rlimit limit;
+			limit.rlim_cur = limit.rlim_max = fileLimit_;
+			signal(SIGXFSZ, SIG_IGN);
+			setrlimit(RLIMIT_FSIZE, &limit);
+		}
+		std::vector<char*> argv;
+		for(size_t i = 0; i < args_.size(); i++) argv.push_back((char*)args_[i].c_str());
+		argv.push_back(NULL);
+		execv(argv[0], argv.data());
+		_exit(127);
+	}
+
+	int status;
+	if(pid < 0 || waitpid(pid, &status, 0) != pid || !WIFEXITED(status)) return -1;
+	return WEXITSTATUS(status);
+}
+
+/// Count of failed checks.
+int numFailed = 0;
+
+/// Record a failed check if a condition is false.
+void check(const bool &condition_, const std::string &name_){
+	if(condition_) return;
+	std::cout << " ERROR: " << name_ << " failed!\n";
+	numFailed++;
+}
+
+/// Check that a file holds exactly the expected words, and report the first difference if not.
+void checkWords(const std::string &fname_, const buffer &expected_, const std::string &name_){
+	buffer words = readFile(fname_);
+	size_t first = 0;
+	while(first < words.size() && first < expected_.size() && words[first] == expected_[first]) first++;
+	if(first == words.size() && first == expected_.size()) return;
+	std::cout << " ERROR: " << name_ << " failed! Output has " << words.size() << " words, expected " << expected_.size() << ", first difference at word " << first << ".\n";
+	numFailed++;
+}
+
+/** Damage a file by removing padding from one buffer, appending padding to another, losing the
+  * header of the second buffer of a spill and overfilling a scaler buffer with data. Returns the
+  * damaged words and sets expected_ to the output of a correct repair.
+  */
+buffer damage(const ldfBuilder &file_, const size_t &underfilled_, const size_t &overpadded_, const size_t &headerless_, const size_t &scaler_, buffer &expected_){
+	buffer words;
+	expected_.clear();
+	for(size_t i = 0; i < file_.buffers.size(); i++){
+		const buffer &buff = file_.buffers[i];
+		if(i == underfilled_){ // Padding is restored.
+			words.insert(words.end(), buff.begin(), buff.end()-100);
+			expected_.insert(expected_.end(), buff.begin(), buff.end());
+		}
+		else if(i == overpadded_){ // Trailing padding is dropped.
+			words.insert(words.end(), buff.begin(), buff.end());
+			words.insert(words.end(), 50, delimiter);
+			expected_.insert(expected_.end(), buff.begin(), buff.end());
+		}
+		else if(i == headerless_){ // The chunks are repacked into the original buffers.
+			words.insert(words.end(), buff.begin()+2, buff.end());
+			expected_.insert(expected_.end(), buff.begin(), buff.end());
+		}
+		else if(i == scaler_){ // The payload is split into buffers with copies of the header.
+			buffer payload(buff.begin()+2, buff.end());
+			for(size_t j = 0; j < 9000; j++) payload.push_back(j+1);
+			words.insert(words.end(), buff.begin(), buff.begin()+2);
+			words.insert(words.end(), payload.begin(), payload.end());
+			for(size_t pos = 0; pos < payload.size(); pos += ldfBufferLength-2){
+				buffer split(buff.begin(), buff.begin()+2);
+				split.insert(split.end(), payload.begin()+pos, payload.begin()+(pos+ldfBufferLength-2 < payload.size() ? pos+ldfBufferLength-2 : payload.size()));
+				split.resize(ldfBufferLength, delimiter);
+				expected_.insert(expected_.end(), split.begin(), split.end());
+			}
+		}
+		else{
+			words.insert(words.end(), buff.begin(), buff.end());
+			expected_.insert(expected_.end(), buff.begin(), buff.end());
+		}
+	}
+	return words;
+}
+
+int main(int argc, char *argv[]){
+	if(argc < 3){
+		std::cout << " Usage: " << argv[0] << " <ldfFixer> <work directory>\n";
+		return 1;
+	}
+	const std::string fixer = argv[1];
+	const std::string dir = std::string(argv[2])+"/";
+
+	// A small file with spills of one, two and three buffers.
+	ldfBuilder file(1);
+	file.addBuffer(DIR, 4);
+	file.addBuffer(HEAD, 62);
+	file.addSpill(4, 500); // Buffer 2.
+	file.addSpill(2, 7000); // Buffers 3 and 4.
+	file.addSpill(3, 7000); // Buffers 5, 6 and 7.
+	file.addBuffer(SCAL, ldfBufferLength-2); // Buffer 8.
+	file.addSpill(6, 100); // Buffer 9.
+	file.addBuffer(ENDFILE, 0);
+	file.addBuffer(ENDFILE, 0);
+	const buffer original = file.getWords();
+	writeFile(dir+"good.ldf", original);
+
+	buffer expected;
+	writeFile(dir+"damaged.ldf", damage(file, 4, 2, 6, 8, expected));
+	check(readFile(dir+"damaged.ldf").size() != expected.size(), "Damaging the file");
+
+	// Interactive and batch repairs.
+	unlink((dir+"interactive.ldf").c_str());
+	check(run({fixer, "-i", dir+"damaged.ldf", "-o", dir+"interactive.ldf", "-j", "4"}, dir+"interactive.log", "y\n") == 0, "Interactive repair");
+	checkWords(dir+"interactive.ldf", expected, "Interactive repair output");
+
+	unlink((dir+"batch.ldf").c_str());
+	check(run({fixer, "-b", "-i", dir+"damaged.ldf", "-o", dir+"batch.ldf"}, dir+"batch.log") == 0, "Batch repair");
+	checkWords(dir+"batch.ldf", expected, "Batch repair output");
+
+	unlink((dir+"clean.ldf").c_str());
+	check(run({fixer, "-b", "-i", dir+"good.ldf", "-o", dir+"clean.ldf"}, dir+"clean.log") == 0, "Batch repair of a valid file");
+	checkWords(dir+"clean.ldf", original, "Batch repair of a valid file output");
+
+	// Duplicate removal. The duplicated buffer holds a complete spill, so the spill is duplicated too.
+	buffer duplicated(original.begin(), original.begin()+3*ldfBufferLength);
+	duplicated.insert(duplicated.end(), original.begin()+2*ldfBufferLength, original.end());
+	writeFile(dir+"duplicated.ldf", duplicated);
+	unlink((dir+"deduplicated.ldf").c_str());
+	check(run({fixer, "-D", "-i", dir+"duplicated.ldf", "-o", dir+"deduplicated.ldf"}, dir+"deduplicated.log") == 0, "Duplicate removal");
+	checkWords(dir+"deduplicated.ldf", original, "Duplicate removal output");
+	std::string log = readText(dir+"deduplicated.log");
+	check(log.find("Found 1 duplicate buffers of 11 and 1 duplicate spills of 5.") != std::string::npos, "Duplicate removal report");
+	check(log.find("Buffer no. 4 \"DATA\" at word 24582 duplicates buffer no. 3 at word 16388") != std::string::npos, "Duplicate buffer report");
+
+	// Validation of the chunk and spill framing.
+	check(run({fixer, "-V", "-i", dir+"good.ldf"}, dir+"valid.log") == 0, "Validation of a valid file");
+	check(readText(dir+"valid.log").find("Found no framing errors in 4 spills") != std::string::npos, "Validation of a valid file report");
+
+	buffer broken = original;
+	broken[4*ldfBufferLength+3] = 7; // Total chunk count of the second chunk of spill no. 2.
+	broken[2*ldfBufferLength+5] = 100000; // Module record length of spill no. 1.
+	writeFile(dir+"broken.ldf", broken);
+	check(run({fixer, "-V", "-i", dir+"broken.ldf", "-j", "3"}, dir+"broken.log") == 1, "Validation of a damaged file");
+	log = readText(dir+"broken.log");
+	check(log.find("Spill no. 1 at word 16388: BAD MODULE RECORDS") != std::string::npos, "Bad module record report");
+	check(log.find("Spill no. 2 at word 32778: BAD CHUNK COUNT") != std::string::npos, "Bad chunk count report");
+	check(log.find("Spill no. 2 at word 38596: BAD CHUNK NUMBER") != std::string::npos, "Discarded spill report");
+	check(log.find("Found 3 framing errors in 2 damaged spills of 4 total.") != std::string::npos, "Validation summary");
+
+	// Resume a checkpointed batch repair which was interrupted by a write error. Checkpoints are
+	// saved between the 16 MB blocks read from the input, so the file holds about 40 MB of spills
+	// of two, three and four modules (using two, two and three buffers). The output is limited to
+	// 20 MB, so the repair fails after the first checkpoint, with damaged buffers on either side.
+	ldfBuilder large(2);
+	large.addBuffer(DIR, 4);
+	large.addBuffer(HEAD, 62);
+	std::vector<size_t> lastBuffers, middleBuffers, scalers;
+	for(size_t i = 0; i < 480; i++){
+		if(large.addSpill(2+i%3, 5000) == 3) middleBuffers.push_back(large.buffers.size()-2);
+		lastBuffers.push_back(large.buffers.size()-1);
+		if(i%10 == 9){
+			large.addBuffer(SCAL, 32);
+			scalers.push_back(large.buffers.size()-1);
+		}
+	}
+	large.addBuffer(ENDFILE, 0);
+	large.addBuffer(ENDFILE, 0);
+	buffer largeExpected;
+	writeFile(dir+"large.ldf", damage(large, lastBuffers[5], lastBuffers[400], middleBuffers[150], scalers[2], largeExpected));
+
+	const std::string resumed = dir+"resumed.ldf";
+	unlink(resumed.c_str());
+	unlink((resumed+".ckpt").c_str());
+	check(run({fixer, "-b", "-c", "1", "-i", dir+"large.ldf", "-o", resumed}, dir+"interrupted.log", "", 20971520) != 0, "Interrupted batch repair");
+	check(access((resumed+".ckpt").c_str(), F_OK) == 0, "Checkpoint of an interrupted repair");
+	check(run({fixer, "-r", "-i", dir+"large.ldf", "-o", resumed}, dir+"resumed.log") == 0, "Resumed batch repair");
+	check(readText(dir+"resumed.log").find("Resuming at input byte") != std::string::npos, "Resumed batch repair report");
+	check(access((resumed+".ckpt").c_str(), F_OK) != 0, "Checkpoint removal after a resumed repair");
+	checkWords(resumed, largeExpected, "Resumed batch repair output");
+
+	unlink((dir+"uninterrupted.ldf").c_str());
+	check(run({fixer, "-b", "-c", "1", "-i", dir+"large.ldf", "-o", dir+"uninterrupted.ldf"}, dir+"uninterrupted.log") == 0, "Uninterrupted batch repair");
+	checkWords(dir+"uninterrupted.ldf", readFile(resumed), "Resumed and uninterrupted output comparison");
+
+	if(numFailed == 0){
+		unlink((dir+"large.ldf").c_str());
+		unlink(resumed.c_str());
+		unlink((dir+"uninterrupted.ldf").c_str());
+		std::cout << " All ldfFixer checks passed.\n";
+	}
+	return (numFailed == 0 ? 0 : 1);
+}